@@ -0,0 +1,388 @@
+/**
+
+                                     +++++
+                                 +++
+                              =++      ++
+                             ++     +=      +++                ++
+                            ++    ++        ++ +++             ++
+                            +    ++   ++   +++   ++++++++    +++
+                           ++   ++   ++     ++++         +++++++
+                           +    +    +      *+++++           +++
+                           +            ++++    +++         +++
+                                        +++++    ++        ++
+                                        +++  ++++*         ++
+                                          ++++++          ++
+                                               +++         +
+                                                +++        ++
+                                                 +++        +++
++++= =+++  +++=         +++   ++++=======         ++          ++           ====
+++++ ++++ ++++          +++  ++++ ========                      ++         ====
+++++ ++++ ++++ ++++++   +++ +++++++++=      +++++=  ++++ +++ +++=+++=  =++==+++
+ ++++++++++++ ++++++++  +++ +++++ =+++++   +++=++++ ++++ +++ ++++=++++ ++++++++
+ ++++++++++++ +++  +++  +++  +++    ++++++++++ ++++ ++++ +++ ++++ ++++ ++++++++
+ ***+*+++++++ **+  +*+  ***  ***      ++++++++ =+++ ++++ +++ ++++ ++++ ++++++++
+  ***** ****+ *** ****  ***  *** ++++ ++++ +++ ++++ ++++ +++ ++++ ++++ ++++++++
+  ****  ****   ******   ***  ***  ++++++++ +++++++   +++++++ ++++ ++++ ++++++++
+                                     *
+             ____                         _   _   _     _   _
+            / ___|    _       _          | | | | | |_  (_) | |  ___
+           | |      _| |_   _| |_        | | | | | __| | | | | / __|
+           | |___  |_   _| |_   _|       | |_| | | |_  | | | | \__ \
+            \____|   |_|     |_|          \___/   \__| |_| |_| |___/
+
+
+  WolfSound C++ Utils
+
+  License:
+
+  MIT License
+
+  Copyright (c) 2024 Jan Wilczek
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+#pragma once
+
+#include <wolfsound/common/wolfsound_assert.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+/** @brief Records the time from here to the end of the enclosing scope
+ * under @p name, a string literal; see wolfsound::Tracer.
+ *
+ * Expands to nothing unless WS_ENABLE_TRACING is defined.
+ */
+#if defined(WS_ENABLE_TRACING)
+#define WS_TRACE_SCOPE(name) \
+  const ::wolfsound::ScopedTrace WS_TRACE_CONCATENATE(wsTrace, __LINE__){name}
+#define WS_TRACE_CONCATENATE(lhs, rhs) WS_TRACE_CONCATENATE_IMPL(lhs, rhs)
+#define WS_TRACE_CONCATENATE_IMPL(lhs, rhs) lhs##rhs
+#else
+#define WS_TRACE_SCOPE(name) static_cast<void>(0)
+#endif
+
+namespace wolfsound {
+struct TraceEvent {
+  /** @brief Must outlive the Tracer, e.g., a string literal. */
+  const char* name = nullptr;
+  /** @brief Since the Tracer has been created. */
+  std::int64_t beginNanoseconds = 0;
+  std::int64_t endNanoseconds = 0;
+};
+
+/** @brief Fixed-capacity ring buffer of the events of one thread.
+ *
+ * Lock-free with one writer, the traced thread, and one reader, the
+ * Tracer. If the reader falls behind, new events are dropped and counted
+ * rather than overwriting the ones it has not read yet.
+ */
+class TraceBuffer {
+public:
+  TraceBuffer(std::size_t capacity, int threadId)
+      : events_(capacity), threadId_{threadId} {
+    WS_PRECONDITION(capacity > 0u && (capacity & (capacity - 1u)) == 0u);
+  }
+
+  /** @brief Called by the traced thread only; never allocates. */
+  void push(const TraceEvent& event) noexcept {
+    const auto head = head_.load(std::memory_order_relaxed);
+    if (head - tail_.load(std::memory_order_acquire) == events_.size()) {
+      numDroppedEvents_.fetch_add(1u, std::memory_order_relaxed);
+      return;
+    }
+    events_[head & (events_.size() - 1u)] = event;
+    head_.store(head + 1u, std::memory_order_release);
+  }
+
+  /** @brief Calls @p consume with every event pushed so far and removes
+   * them. Called by the reader only. */
+  template <typename Consume>
+  void drain(Consume&& consume) {
+    const auto head = head_.load(std::memory_order_acquire);
+    auto tail = tail_.load(std::memory_order_relaxed);
+    for (; tail != head; ++tail) {
+      consume(events_[tail & (events_.size() - 1u)]);
+    }
+    tail_.store(tail, std::memory_order_release);
+  }
+
+  /** @brief Events dropped because the buffer was full; resets the count.
+   */
+  [[nodiscard]] std::size_t takeNumDroppedEvents() noexcept {
+    return numDroppedEvents_.exchange(0u, std::memory_order_relaxed);
+  }
+
+  [[nodiscard]] int getThreadId() const noexcept { return threadId_; }
+
+  void setThreadName(std::string name) { threadName_ = std::move(name); }
+
+  [[nodiscard]] const std::string& getThreadName() const noexcept {
+    return threadName_;
+  }
+
+  /** @brief Called by the traced thread when it exits; it pushes no events
+   * after that. */
+  void markThreadExited() noexcept {
+    threadExited_.store(true, std::memory_order_release);
+  }
+
+  /** @brief True if the traced thread has exited. Every event it pushed is
+   * visible to a drain() that follows. */
+  [[nodiscard]] bool hasThreadExited() const noexcept {
+    return threadExited_.load(std::memory_order_acquire);
+  }
+
+private:
+  std::vector<TraceEvent> events_;
+  // only ever incremented; wrap around after 2^64 events
+  std::atomic<std::size_t> head_{0u};
+  std::atomic<std::size_t> tail_{0u};
+  std::atomic<std::size_t> numDroppedEvents_{0u};
+  std::atomic<bool> threadExited_{false};
+  int threadId_;
+  std::string threadName_;
+};
+
+/** @brief Collects the events of WS_TRACE_SCOPE from all threads and
+ * exports them in the Chrome trace event format.
+ *
+ * Each thread records into its own TraceBuffer, allocated the first time it
+ * traces a scope. Call prepareCurrentThread() beforehand, e.g., in
+ * prepareToPlay() or at the start of a worker, to keep that allocation out
+ * of the audio callback. Recording a scope then takes two clock reads and
+ * no locks. The buffer of a thread that has exited is freed by the first
+ * writeChromeTrace() or clear() after its exit, once its events are
+ * exported or removed.
+ *
+ * The exported JSON opens in chrome://tracing and https://ui.perfetto.dev.
+ *
+ * @code
+ * void process(const Context& context) {
+ *   WS_TRACE_SCOPE("Reverb::process");
+ *   ...
+ * }
+ *
+ * std::ofstream file{"session.json"};
+ * Tracer::getInstance().writeChromeTrace(file);
+ * @endcode
+ */
+class Tracer {
+public:
+  /** @brief Events each thread can hold between two exports. */
+  static constexpr std::size_t EVENTS_PER_THREAD = 1u << 16u;
+
+  [[nodiscard]] static Tracer& getInstance() {
+    static Tracer tracer;
+    return tracer;
+  }
+
+  /** @brief Allocates the buffer of the calling thread and names the
+   * thread in the exported trace. */
+  void prepareCurrentThread(std::string threadName = {});
+
+  /** @brief Writes the events recorded since the last export as Chrome
+   * trace JSON and removes them. */
+  void writeChromeTrace(std::ostream& output);
+
+  /** @brief Removes the events recorded so far. */
+  void clear();
+
+  /** @brief Buffers currently allocated: one per thread that has traced and
+   * has not exited, or whose events have not been exported since. */
+  [[nodiscard]] std::size_t getNumThreadBuffers();
+
+  [[nodiscard]] std::int64_t nowInNanoseconds() const noexcept {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now() - epoch_)
+        .count();
+  }
+
+  /** @brief The buffer of the calling thread; allocates it on first use. */
+  [[nodiscard]] TraceBuffer& getCurrentThreadBuffer() {
+    // the Tracer keeps the buffer after the thread exits so that its events
+    // can still be exported; it frees the buffer once they are
+    struct Registration {
+      TraceBuffer* buffer = nullptr;
+
+      ~Registration() {
+        if (buffer != nullptr) {
+          buffer->markThreadExited();
+        }
+      }
+    };
+    thread_local Registration registration;
+    if (registration.buffer == nullptr) {
+      registration.buffer = &registerCurrentThread();
+    }
+    return *registration.buffer;
+  }
+
+private:
+  Tracer() = default;
+
+  TraceBuffer& registerCurrentThread();
+
+  /** @brief Drains every buffer with @p consume and frees those of the
+   * threads that had exited before. Called with mutex_ held. */
+  template <typename Consume>
+  std::size_t drainAll(Consume&& consume);
+
+  const std::chrono::steady_clock::time_point epoch_ =
+      std::chrono::steady_clock::now();
+  std::mutex mutex_;
+  std::vector<std::unique_ptr<TraceBuffer>> buffers_;
+  // not reused, so that a thread id in a trace names a single thread
+  int nextThreadId_ = 1;
+};
+
+/** @brief Records a TraceEvent spanning its lifetime; see WS_TRACE_SCOPE.
+ */
+class ScopedTrace {
+public:
+  explicit ScopedTrace(const char* name) noexcept
+      : name_{name}, begin_{Tracer::getInstance().nowInNanoseconds()} {}
+
+  ~ScopedTrace() {
+    auto& tracer = Tracer::getInstance();
+    tracer.getCurrentThreadBuffer().push(
+        {name_, begin_, tracer.nowInNanoseconds()});
+  }
+
+  ScopedTrace(const ScopedTrace&) = delete;
+  ScopedTrace& operator=(const ScopedTrace&) = delete;
+
+private:
+  const char* name_;
+  std::int64_t begin_;
+};
+
+namespace detail {
+inline void writeJsonString(std::ostream& output, const char* text) {
+  output << '"';
+  for (; *text != '\0'; ++text) {
+    const auto character = static_cast<unsigned char>(*text);
+    if (character == '"' || character == '\\') {
+      output << '\\' << *text;
+    } else if (character < 0x20u) {
+      char escaped[8];
+      std::snprintf(escaped, sizeof(escaped), "\\u%04x", character);
+      output << escaped;
+    } else {
+      output << *text;
+    }
+  }
+  output << '"';
+}
+
+/** @brief Chrome trace timestamps are in microseconds. */
+inline void writeMicroseconds(std::ostream& output,
+                              std::int64_t nanoseconds) {
+  char text[32];
+  std::snprintf(text, sizeof(text), "%lld.%03lld",
+                static_cast<long long>(nanoseconds / 1000),
+                static_cast<long long>(nanoseconds % 1000));
+  output << text;
+}
+}  // namespace detail
+
+inline void Tracer::prepareCurrentThread(std::string threadName) {
+  auto& buffer = getCurrentThreadBuffer();
+  const std::scoped_lock lock{mutex_};
+  buffer.setThreadName(std::move(threadName));
+}
+
+inline TraceBuffer& Tracer::registerCurrentThread() {
+  const std::scoped_lock lock{mutex_};
+  buffers_.push_back(
+      std::make_unique<TraceBuffer>(EVENTS_PER_THREAD, nextThreadId_++));
+  return *buffers_.back();
+}
+
+template <typename Consume>
+std::size_t Tracer::drainAll(Consume&& consume) {
+  std::size_t numDroppedEvents = 0u;
+  std::erase_if(buffers_, [&](const std::unique_ptr<TraceBuffer>& buffer) {
+    // checked before draining: events pushed after the check would be lost
+    // if the buffer were freed
+    const auto threadExited = buffer->hasThreadExited();
+    consume(*buffer);
+    numDroppedEvents += buffer->takeNumDroppedEvents();
+    return threadExited;
+  });
+  return numDroppedEvents;
+}
+
+inline void Tracer::writeChromeTrace(std::ostream& output) {
+  const std::scoped_lock lock{mutex_};
+  output << R"({"displayTimeUnit":"ns","traceEvents":[)";
+  auto first = true;
+  const auto separate = [&] {
+    if (!first) {
+      output << ',';
+    }
+    first = false;
+  };
+
+  const auto numDroppedEvents = drainAll([&](TraceBuffer& buffer) {
+    if (!buffer.getThreadName().empty()) {
+      separate();
+      output << R"({"name":"thread_name","ph":"M","pid":1,"tid":)"
+             << buffer.getThreadId() << R"(,"args":{"name":)";
+      detail::writeJsonString(output, buffer.getThreadName().c_str());
+      output << "}}";
+    }
+
+    buffer.drain([&](const TraceEvent& event) {
+      separate();
+      output << R"({"name":)";
+      detail::writeJsonString(output, event.name);
+      output << R"(,"ph":"X","pid":1,"tid":)" << buffer.getThreadId()
+             << R"(,"ts":)";
+      detail::writeMicroseconds(output, event.beginNanoseconds);
+      output << R"(,"dur":)";
+      detail::writeMicroseconds(output,
+                                event.endNanoseconds - event.beginNanoseconds);
+      output << '}';
+    });
+  });
+
+  output << R"(],"otherData":{"droppedEvents":)" << numDroppedEvents
+         << "}}";
+}
+
+inline void Tracer::clear() {
+  const std::scoped_lock lock{mutex_};
+  static_cast<void>(drainAll(
+      [](TraceBuffer& buffer) { buffer.drain([](const TraceEvent&) {}); }));
+}
+
+inline std::size_t Tracer::getNumThreadBuffers() {
+  const std::scoped_lock lock{mutex_};
+  return buffers_.size();
+}
+}  // namespace wolfsound
@@ -0,0 +1,278 @@
+/**
+
+                                     +++++
+                                 +++
+                              =++      ++
+                             ++     +=      +++                ++
+                            ++    ++        ++ +++             ++
+                            +    ++   ++   +++   ++++++++    +++
+                           ++   ++   ++     ++++         +++++++
+                           +    +    +      *+++++           +++
+                           +            ++++    +++         +++
+                                        +++++    ++        ++
+                                        +++  ++++*         ++
+                                          ++++++          ++
+                                               +++         +
+                                                +++        ++
+                                                 +++        +++
++++= =+++  +++=         +++   ++++=======         ++          ++           ====
+++++ ++++ ++++          +++  ++++ ========                      ++         ====
+++++ ++++ ++++ ++++++   +++ +++++++++=      +++++=  ++++ +++ +++=+++=  =++==+++
+ ++++++++++++ ++++++++  +++ +++++ =+++++   +++=++++ ++++ +++ ++++=++++ ++++++++
+ ++++++++++++ +++  +++  +++  +++    ++++++++++ ++++ ++++ +++ ++++ ++++ ++++++++
+ ***+*+++++++ **+  +*+  ***  ***      ++++++++ =+++ ++++ +++ ++++ ++++ ++++++++
+  ***** ****+ *** ****  ***  *** ++++ ++++ +++ ++++ ++++ +++ ++++ ++++ ++++++++
+  ****  ****   ******   ***  ***  ++++++++ +++++++   +++++++ ++++ ++++ ++++++++
+                                     *
+             ____                         _   _   _     _   _
+            / ___|    _       _          | | | | | |_  (_) | |  ___
+           | |      _| |_   _| |_        | | | | | __| | | | | / __|
+           | |___  |_   _| |_   _|       | |_| | | |_  | | | | \__ \
+            \____|   |_|     |_|          \___/   \__| |_| |_| |___/
+
+
+  WolfSound C++ Utils
+
+  License:
+
+  MIT License
+
+  Copyright (c) 2024 Jan Wilczek
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#pragma once
+
+#include <wolfsound/common/wolfsound_assert.hpp>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace wolfsound {
+/** @brief Converts float samples to 16- or 24-bit PCM with optional TPDF
+ * dither and noise shaping.
+ *
+ * Samples are scaled so that [-1, 1) spans the target bit depth, dithered,
+ * rounded to the nearest integer, and clipped. The dither is triangular
+ * (the sum of two uniform variables, +/-1 LSB peak), which makes the
+ * quantization error independent of the signal. Noise shaping feeds the
+ * quantization error back, pushing its spectrum towards high frequencies.
+ *
+ * The output is left-justified in 32 bits, which is the layout
+ * juce::AudioFormatWriter::write() takes; shift it right by
+ * 32 - bitsPerSample to get the plain sample values.
+ *
+ * Without noise shaping, samples are processed in independent lanes, each
+ * with its own xorshift generator, so that the compiler can vectorize the
+ * loop. Noise shaping makes every sample depend on the previous ones; only
+ * the dither generation is vectorized then.
+ */
+class FloatToPcmConverter {
+public:
+  enum class NoiseShaping {
+    NONE,
+    /** @brief Error spectrum shaped by (1 - z^-1), +6 dB per octave. */
+    FIRST_ORDER,
+    /** @brief Error spectrum shaped by (1 - z^-1)^2, +12 dB per octave. */
+    SECOND_ORDER
+  };
+
+  struct Args {
+    int bitsPerSample = 16;
+    int numChannels = 1;
+    bool dither = true;
+    NoiseShaping noiseShaping = NoiseShaping::NONE;
+    /** @brief Equal seeds and block sizes give bit-identical output. */
+    std::uint32_t seed = 1u;
+  };
+
+  explicit FloatToPcmConverter(Args);
+
+  /** @brief Converts @p numSamples samples of @p channel.
+   *
+   * Consecutive calls for a channel continue its noise-shaping state.
+   */
+  void convert(const float* input,
+               std::int32_t* output,
+               int numSamples,
+               int channel) noexcept;
+
+  /** @brief Clears the noise-shaping state of all channels. */
+  void reset() noexcept;
+
+  [[nodiscard]] int getBitsPerSample() const noexcept {
+    return bitsPerSample_;
+  }
+
+private:
+  static constexpr auto LANES = 8;
+  using Lanes = std::array<double, LANES>;
+
+  struct ErrorHistory {
+    double previous = 0.0;
+    double beforePrevious = 0.0;
+  };
+
+  void generateDither() noexcept;
+  [[nodiscard]] std::int32_t toPcm(double scaled) const noexcept;
+  void convertShaped(const float* input,
+                     std::int32_t* output,
+                     int numSamples,
+                     ErrorHistory& errors) noexcept;
+
+  int bitsPerSample_;
+  double scale_;
+  std::int32_t justification_;
+  bool dithers_;
+  std::array<double, 2> feedback_{};
+  bool shapesNoise_;
+
+  std::array<std::uint32_t, LANES> rngStates_{};
+  Lanes ditherLanes_{};
+  std::vector<ErrorHistory> errors_;
+};
+
+namespace detail {
+/** @brief Marsaglia's xorshift32; never returns 0 for a nonzero state. */
+[[nodiscard]] inline std::uint32_t xorshift32(std::uint32_t& state) noexcept {
+  state ^= state << 13;
+  state ^= state >> 17;
+  state ^= state << 5;
+  return state;
+}
+
+/** @brief Uniform in [0, 1) from the top 24 bits of a random word. */
+[[nodiscard]] inline double unitInterval(std::uint32_t random) noexcept {
+  constexpr auto ONE_OVER_2_TO_24 = 1.0 / (1 << 24);
+  return static_cast<double>(random >> 8) * ONE_OVER_2_TO_24;
+}
+}  // namespace detail
+
+inline FloatToPcmConverter::FloatToPcmConverter(Args args)
+    : bitsPerSample_{args.bitsPerSample},
+      scale_{static_cast<double>(1 << (args.bitsPerSample - 1))},
+      justification_{1 << (32 - args.bitsPerSample)},
+      dithers_{args.dither},
+      shapesNoise_{args.noiseShaping != NoiseShaping::NONE},
+      errors_(static_cast<std::size_t>(args.numChannels)) {
+  WS_PRECONDITION(args.bitsPerSample == 16 || args.bitsPerSample == 24);
+  WS_PRECONDITION(args.numChannels > 0);
+
+  switch (args.noiseShaping) {
+    case NoiseShaping::FIRST_ORDER:
+      feedback_ = {1.0, 0.0};
+      break;
+    case NoiseShaping::SECOND_ORDER:
+      feedback_ = {2.0, -1.0};
+      break;
+    case NoiseShaping::NONE:
+    default:
+      break;
+  }
+
+  // decorrelate the lanes with MurmurHash3's finalizer
+  for (auto lane = 0u; lane < rngStates_.size(); ++lane) {
+    auto state = args.seed + lane * 0x9E3779B9u;
+    state ^= state >> 16;
+    state *= 0x85EBCA6Bu;
+    state ^= state >> 13;
+    state *= 0xC2B2AE35u;
+    state ^= state >> 16;
+    rngStates_[lane] = state != 0u ? state : 1u;
+  }
+}
+
+inline void FloatToPcmConverter::convert(const float* input,
+                                         std::int32_t* output,
+                                         int numSamples,
+                                         int channel) noexcept {
+  WS_PRECONDITION(0 <= channel && channel < std::ssize(errors_));
+  if (shapesNoise_) {
+    convertShaped(input, output, numSamples,
+                  errors_[static_cast<std::size_t>(channel)]);
+    return;
+  }
+
+  auto i = 0;
+  for (; i + LANES <= numSamples; i += LANES) {
+    generateDither();
+    for (auto lane = 0; lane < LANES; ++lane) {
+      output[i + lane] = toPcm(static_cast<double>(input[i + lane]) * scale_ +
+                               ditherLanes_[lane]);
+    }
+  }
+  if (i < numSamples) {
+    generateDither();
+    for (auto lane = 0; i + lane < numSamples; ++lane) {
+      output[i + lane] = toPcm(static_cast<double>(input[i + lane]) * scale_ +
+                               ditherLanes_[lane]);
+    }
+  }
+}
+
+inline void FloatToPcmConverter::reset() noexcept {
+  std::ranges::fill(errors_, ErrorHistory{});
+}
+
+inline void FloatToPcmConverter::generateDither() noexcept {
+  if (!dithers_) {
+    return;
+  }
+  for (auto lane = 0; lane < LANES; ++lane) {
+    const auto first =
+        detail::unitInterval(detail::xorshift32(rngStates_[lane]));
+    const auto second =
+        detail::unitInterval(detail::xorshift32(rngStates_[lane]));
+    ditherLanes_[lane] = first + second - 1.0;
+  }
+}
+
+inline std::int32_t FloatToPcmConverter::toPcm(double scaled) const noexcept {
+  // after clipping, the offset value is positive, so truncating it rounds
+  // like std::floor() would; unlike std::floor(), this vectorizes without
+  // -ffast-math
+  const auto clipped = std::clamp(scaled, -scale_, scale_ - 1.0);
+  const auto offset = static_cast<std::int32_t>(scale_);
+  const auto rounded =
+      static_cast<std::int32_t>(clipped + scale_ + 0.5) - offset;
+  return rounded * justification_;
+}
+
+inline void FloatToPcmConverter::convertShaped(const float* input,
+                                               std::int32_t* output,
+                                               int numSamples,
+                                               ErrorHistory& errors) noexcept {
+  for (auto i = 0; i < numSamples; i += LANES) {
+    generateDither();
+    for (auto lane = 0; lane < LANES && i + lane < numSamples; ++lane) {
+      const auto target = static_cast<double>(input[i + lane]) * scale_ -
+                          feedback_[0] * errors.previous -
+                          feedback_[1] * errors.beforePrevious;
+      const auto quantized = std::floor(target + ditherLanes_[lane] + 0.5);
+      output[i + lane] = toPcm(quantized);
+      errors.beforePrevious = errors.previous;
+      // the error before clipping keeps the feedback bounded on overloads
+      errors.previous = quantized - target;
+    }
+  }
+}
+}  // namespace wolfsound
@@ -155,6 +155,18 @@ inline std::vector<float> generateNonaliasingSawRampDown(Frequency frequency,
   return result;
 }
 
+/** @brief A unit impulse at the first sample, followed by silence. */
+inline std::vector<float> generateImpulse(Frequency sampleRate,
+                                          Seconds duration) {
+  WS_PRECONDITION(sampleRate > 0_Hz);
+
+  std::vector<float> result(samplesCountFrom(sampleRate, duration), 0.f);
+  if (!result.empty()) {
+    result.front() = 1.f;
+  }
+  return result;
+}
+
 inline std::vector<float> generateWhiteNoise(
     Frequency sampleRate,
     Seconds duration,
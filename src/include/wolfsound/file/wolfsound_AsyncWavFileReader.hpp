@@ -0,0 +1,723 @@
+#pragma once
+
+#include <wolfsound/common/wolfsound_WhenLeavingScopeExecute.hpp>
+#include <wolfsound/common/wolfsound_assert.hpp>
+#include <wolfsound/file/wolfsound_DecodedAudioCache.hpp>
+#include <wolfsound/file/wolfsound_WavDataLayout.hpp>
+#include <juce_core/juce_core.h>
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <climits>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#if __has_include(<linux/io_uring.h>) && defined(__NR_io_uring_setup)
+#include <linux/io_uring.h>
+// defined by linux/fs.h, which linux/io_uring.h includes; a name as common
+// as this one would break code that merely includes WavFileReader
+#undef BLOCK_SIZE
+#undef BLOCK_SIZE_BITS
+#define WS_HAS_IO_URING 1
+#endif
+#endif
+
+#ifndef WS_HAS_IO_URING
+#define WS_HAS_IO_URING 0
+#endif
+
+namespace wolfsound {
+/** @brief Consecutive whole frames read from the data chunk of a WAV file.
+ *
+ * The chunk shares ownership of its read buffer; the buffer is recycled for
+ * further reads once the last copy of the chunk is destroyed.
+ */
+class WavDataChunk {
+public:
+  WavDataChunk(const WavDataLayout& layout,
+               std::int64_t startSample,
+               std::shared_ptr<const std::vector<std::byte>> buffer,
+               std::size_t sizeInBytes)
+      : layout_{&layout},
+        startSample_{startSample},
+        buffer_{std::move(buffer)},
+        sizeInBytes_{sizeInBytes} {
+    WS_PRECONDITION(sizeInBytes <= buffer_->size());
+  }
+
+  [[nodiscard]] const WavDataLayout& getLayout() const noexcept {
+    return *layout_;
+  }
+
+  /** @brief Index of the first frame of this chunk in the whole file. */
+  [[nodiscard]] std::int64_t getStartSample() const noexcept {
+    return startSample_;
+  }
+
+  [[nodiscard]] std::int64_t getNumSamples() const noexcept {
+    return static_cast<std::int64_t>(sizeInBytes_) /
+           layout_->getBytesPerFrame();
+  }
+
+  /** @brief Interleaved little-endian frames as stored in the file. */
+  [[nodiscard]] std::span<const std::byte> getBytes() const noexcept {
+    return {buffer_->data(), sizeInBytes_};
+  }
+
+  /** @brief Writes getNumSamples() float samples to each destination
+   * channel; the caller offsets the pointers by getStartSample(). */
+  void decodeTo(float* const* destinationChannels) const {
+    layout_->decode(getBytes(), destinationChannels);
+  }
+
+private:
+  const WavDataLayout* layout_;
+  std::int64_t startSample_;
+  std::shared_ptr<const std::vector<std::byte>> buffer_;
+  std::size_t sizeInBytes_;
+};
+
+namespace detail {
+/** @brief Fixed set of equally sized byte buffers handed out as
+ * std::shared_ptr that return to the pool when released. */
+class ChunkBufferPool {
+public:
+  ChunkBufferPool(std::size_t numBuffers, std::size_t bufferSizeInBytes)
+      : numBuffers_{numBuffers} {
+    // never reallocates in the deleter
+    free_.reserve(numBuffers);
+    for (auto i = 0u; i < numBuffers; ++i) {
+      free_.push_back(
+          std::make_unique<std::vector<std::byte>>(bufferSizeInBytes));
+    }
+  }
+
+  ChunkBufferPool(const ChunkBufferPool&) = delete;
+  ChunkBufferPool& operator=(const ChunkBufferPool&) = delete;
+
+  ~ChunkBufferPool() { waitUntilAllReturned(); }
+
+  /** @brief Blocks until a buffer is free. */
+  [[nodiscard]] std::shared_ptr<std::vector<std::byte>> acquire() {
+    std::unique_lock lock{mutex_};
+    returned_.wait(lock, [this] { return !free_.empty(); });
+    auto* buffer = free_.back().release();
+    free_.pop_back();
+    return {buffer, [this](std::vector<std::byte>* released) {
+              const std::scoped_lock releaseLock{mutex_};
+              free_.emplace_back(released);
+              // notify under the lock: the pool may be destroyed right after
+              returned_.notify_all();
+            }};
+  }
+
+  void waitUntilAllReturned() {
+    std::unique_lock lock{mutex_};
+    returned_.wait(lock, [this] { return free_.size() == numBuffers_; });
+  }
+
+private:
+  const std::size_t numBuffers_;
+  std::mutex mutex_;
+  std::condition_variable returned_;
+  std::vector<std::unique_ptr<std::vector<std::byte>>> free_;
+};
+
+#if WS_HAS_IO_URING
+/** @brief Minimal io_uring instance driven through the raw system calls, so
+ * that liburing is not required. Not thread-safe. */
+class IoUring {
+public:
+  /** @throws std::system_error if the kernel does not support io_uring or
+   * it is disallowed (e.g., by a container's seccomp profile) */
+  explicit IoUring(unsigned numEntries);
+
+  IoUring(const IoUring&) = delete;
+  IoUring& operator=(const IoUring&) = delete;
+
+  ~IoUring() { release(); }
+
+  [[nodiscard]] unsigned getNumEntries() const noexcept { return numEntries_; }
+
+  /** @brief Queues a readv request; @p vector must stay valid until the
+   * request completes. */
+  void prepareRead(int fileDescriptor,
+                   const iovec* vector,
+                   std::uint64_t offset,
+                   std::uint64_t userData);
+
+  /** @brief Submits queued requests and waits for at least
+   * @p minCompletions completions. */
+  void submitAndWait(unsigned minCompletions);
+
+  template <typename Callback>
+  void forEachCompletion(Callback&& callback);
+
+private:
+  void release() noexcept;
+
+  int fileDescriptor_ = -1;
+  unsigned numEntries_ = 0u;
+  void* submissionRing_ = MAP_FAILED;
+  std::size_t submissionRingSize_ = 0u;
+  void* completionRing_ = MAP_FAILED;
+  std::size_t completionRingSize_ = 0u;
+  io_uring_sqe* submissionEntries_ = nullptr;
+  std::size_t submissionEntriesSize_ = 0u;
+
+  unsigned* submissionHead_ = nullptr;
+  unsigned* submissionTail_ = nullptr;
+  unsigned submissionMask_ = 0u;
+  unsigned* submissionArray_ = nullptr;
+  unsigned* completionHead_ = nullptr;
+  unsigned* completionTail_ = nullptr;
+  unsigned completionMask_ = 0u;
+  io_uring_cqe* completionEntries_ = nullptr;
+
+  unsigned localSubmissionTail_ = 0u;
+  unsigned numUnsubmitted_ = 0u;
+};
+
+inline IoUring::IoUring(unsigned numEntries) {
+  io_uring_params parameters{};
+  fileDescriptor_ = static_cast<int>(
+      syscall(__NR_io_uring_setup, numEntries, &parameters));
+  if (fileDescriptor_ < 0) {
+    throw std::system_error{errno, std::generic_category(), "io_uring_setup"};
+  }
+  numEntries_ = parameters.sq_entries;
+
+  submissionRingSize_ =
+      parameters.sq_off.array + parameters.sq_entries * sizeof(unsigned);
+  completionRingSize_ =
+      parameters.cq_off.cqes + parameters.cq_entries * sizeof(io_uring_cqe);
+  const auto singleMapping = (parameters.features & IORING_FEAT_SINGLE_MMAP);
+  if (singleMapping) {
+    submissionRingSize_ = completionRingSize_ =
+        std::max(submissionRingSize_, completionRingSize_);
+  }
+
+  auto map = [this](std::size_t size, off_t offset) {
+    auto* mapped = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_POPULATE, fileDescriptor_, offset);
+    if (mapped == MAP_FAILED) {
+      const auto error = errno;
+      release();
+      throw std::system_error{error, std::generic_category(), "mmap"};
+    }
+    return mapped;
+  };
+
+  submissionRing_ = map(submissionRingSize_, IORING_OFF_SQ_RING);
+  completionRing_ = singleMapping
+                        ? submissionRing_
+                        : map(completionRingSize_, IORING_OFF_CQ_RING);
+  submissionEntriesSize_ = parameters.sq_entries * sizeof(io_uring_sqe);
+  submissionEntries_ = static_cast<io_uring_sqe*>(
+      map(submissionEntriesSize_, IORING_OFF_SQES));
+
+  auto* submissionBase = static_cast<char*>(submissionRing_);
+  submissionHead_ =
+      reinterpret_cast<unsigned*>(submissionBase + parameters.sq_off.head);
+  submissionTail_ =
+      reinterpret_cast<unsigned*>(submissionBase + parameters.sq_off.tail);
+  submissionMask_ = *reinterpret_cast<unsigned*>(submissionBase +
+                                                 parameters.sq_off.ring_mask);
+  submissionArray_ =
+      reinterpret_cast<unsigned*>(submissionBase + parameters.sq_off.array);
+
+  auto* completionBase = static_cast<char*>(completionRing_);
+  completionHead_ =
+      reinterpret_cast<unsigned*>(completionBase + parameters.cq_off.head);
+  completionTail_ =
+      reinterpret_cast<unsigned*>(completionBase + parameters.cq_off.tail);
+  completionMask_ = *reinterpret_cast<unsigned*>(completionBase +
+                                                 parameters.cq_off.ring_mask);
+  completionEntries_ = reinterpret_cast<io_uring_cqe*>(
+      completionBase + parameters.cq_off.cqes);
+
+  localSubmissionTail_ = *submissionTail_;
+}
+
+inline void IoUring::release() noexcept {
+  if (submissionEntries_ != nullptr) {
+    munmap(submissionEntries_, submissionEntriesSize_);
+  }
+  if (completionRing_ != MAP_FAILED && completionRing_ != submissionRing_) {
+    munmap(completionRing_, completionRingSize_);
+  }
+  if (submissionRing_ != MAP_FAILED) {
+    munmap(submissionRing_, submissionRingSize_);
+  }
+  if (fileDescriptor_ >= 0) {
+    close(fileDescriptor_);
+  }
+  submissionEntries_ = nullptr;
+  completionRing_ = submissionRing_ = MAP_FAILED;
+  fileDescriptor_ = -1;
+}
+
+inline void IoUring::prepareRead(int fileDescriptor,
+                                 const iovec* vector,
+                                 std::uint64_t offset,
+                                 std::uint64_t userData) {
+  const auto head = std::atomic_ref<unsigned>{*submissionHead_}.load(
+      std::memory_order_acquire);
+  WS_ASSERT(localSubmissionTail_ - head < numEntries_,
+            "more requests in flight than the ring has entries");
+
+  const auto index = localSubmissionTail_ & submissionMask_;
+  auto& entry = submissionEntries_[index];
+  std::memset(&entry, 0, sizeof(entry));
+  entry.opcode = IORING_OP_READV;
+  entry.fd = fileDescriptor;
+  entry.off = offset;
+  entry.addr = reinterpret_cast<std::uint64_t>(vector);
+  entry.len = 1u;
+  entry.user_data = userData;
+  submissionArray_[index] = index;
+
+  ++localSubmissionTail_;
+  ++numUnsubmitted_;
+}
+
+inline void IoUring::submitAndWait(unsigned minCompletions) {
+  // make the entries visible to the kernel before it reads the new tail
+  std::atomic_ref<unsigned>{*submissionTail_}.store(localSubmissionTail_,
+                                                    std::memory_order_release);
+  while (true) {
+    const auto submitted =
+        syscall(__NR_io_uring_enter, fileDescriptor_, numUnsubmitted_,
+                minCompletions, IORING_ENTER_GETEVENTS, nullptr, 0);
+    if (submitted >= 0) {
+      numUnsubmitted_ -= static_cast<unsigned>(submitted);
+      return;
+    }
+    if (errno != EINTR) {
+      throw std::system_error{errno, std::generic_category(),
+                              "io_uring_enter"};
+    }
+  }
+}
+
+template <typename Callback>
+void IoUring::forEachCompletion(Callback&& callback) {
+  auto head = *completionHead_;
+  const auto tail = std::atomic_ref<unsigned>{*completionTail_}.load(
+      std::memory_order_acquire);
+  for (; head != tail; ++head) {
+    // copy so that the entry can be reused by the kernel immediately
+    const auto completion = completionEntries_[head & completionMask_];
+    std::atomic_ref<unsigned>{*completionHead_}.store(
+        head + 1u, std::memory_order_release);
+    callback(completion);
+  }
+}
+#endif
+}  // namespace detail
+
+/** @brief Reads the samples of a WAV file with many reads in flight and
+ * hands every chunk to a caller-supplied decode pipeline as soon as it
+ * arrives.
+ *
+ * On Linux, up to queueDepth chunk reads are kept outstanding in an
+ * io_uring, which lets the kernel and the drive schedule them freely while
+ * the pipeline decodes on other cores. Where io_uring is not available
+ * (other platforms, old kernels, or disallowed by seccomp), a thread pool
+ * issues positional blocking reads instead.
+ *
+ * Memory stays bounded: once the pipeline holds maxChunksInPipeline chunks,
+ * reading pauses until it releases one.
+ *
+ * @code
+ * AsyncWavFileReader reader;
+ * reader.read(file, [&](WavDataChunk chunk) {
+ *   decodeThreadPool.addJob([&, chunk = std::move(chunk)] {
+ *     chunk.decodeTo(destinationsAt(chunk.getStartSample()));
+ *   });
+ * });
+ * @endcode
+ */
+class AsyncWavFileReader {
+public:
+  enum class Backend { IO_URING, THREAD_POOL };
+
+  struct Args {
+    /** @brief Bytes per read; rounded down to whole frames. */
+    std::size_t chunkSizeInBytes = 1u << 20u;
+
+    /** @brief Number of reads kept in flight by io_uring. */
+    unsigned queueDepth = 32u;
+
+    /** @brief Chunks the pipeline may hold before reading pauses. */
+    unsigned maxChunksInPipeline = 32u;
+
+    /** @brief Reading threads if io_uring cannot be used. */
+    unsigned numThreads = 4u;
+
+    /** @brief If false, the thread pool is used even if io_uring works. */
+    bool useIoUring = true;
+  };
+
+  /** @brief Called for every chunk, in no particular order.
+   *
+   * With the thread-pool backend, it is called concurrently from several
+   * threads. It may keep the chunk (e.g., pass it on to another thread) but
+   * read() returns only once all chunks have been released.
+   */
+  using ChunkCallback = std::function<void(WavDataChunk)>;
+
+  AsyncWavFileReader() : AsyncWavFileReader{Args{}} {}
+
+  explicit AsyncWavFileReader(Args args);
+
+  /** @brief Reads the whole data chunk of @p file into @p onChunk.
+   *
+   * Exceptions thrown by @p onChunk stop further reads and are rethrown
+   * once the reads in flight have completed. Only one read() per instance
+   * may run at a time.
+   *
+   * @throws std::runtime_error if the file cannot be opened or parsed
+   * @throws std::system_error if a read fails
+   */
+  WavDataLayout read(const juce::File& file, const ChunkCallback& onChunk);
+
+  /** @brief Reads and decodes @p file to floats; chunks are decoded on the
+   * reading thread(s) as soon as they arrive.
+   *
+   * @throws std::runtime_error also if the file has more than INT_MAX
+   * frames, the most a juce::AudioBuffer holds
+   */
+  [[nodiscard]] std::shared_ptr<DecodedAudio> decode(const juce::File& file);
+
+  [[nodiscard]] Backend getBackend() const noexcept {
+    return backend_ == nullptr ? Backend::THREAD_POOL : Backend::IO_URING;
+  }
+
+private:
+  struct ChunkGeometry {
+    std::size_t sizeInBytes;
+    std::int64_t count;
+  };
+
+  [[nodiscard]] ChunkGeometry chunkGeometryOf(
+      const WavDataLayout& layout) const;
+  [[nodiscard]] static WavDataLayout readLayout(const juce::File& file);
+
+  void read(const juce::File& file,
+            const WavDataLayout& layout,
+            const ChunkCallback& onChunk);
+  void readWithThreadPool(const juce::File& file,
+                          const WavDataLayout& layout,
+                          const ChunkCallback& onChunk);
+#if WS_HAS_IO_URING
+  void readWithIoUring(const juce::File& file,
+                       const WavDataLayout& layout,
+                       const ChunkCallback& onChunk);
+  using IoUringBackend = detail::IoUring;
+#else
+  struct IoUringBackend {};
+#endif
+
+  Args args_;
+  std::unique_ptr<IoUringBackend> backend_;
+};
+
+inline AsyncWavFileReader::AsyncWavFileReader(Args args)
+    : args_{std::move(args)} {
+  WS_PRECONDITION(args_.chunkSizeInBytes > 0u);
+  WS_PRECONDITION(args_.chunkSizeInBytes <= static_cast<std::size_t>(INT_MAX));
+  WS_PRECONDITION(args_.queueDepth > 0u);
+  WS_PRECONDITION(args_.numThreads > 0u);
+
+#if WS_HAS_IO_URING
+  if (args_.useIoUring) {
+    try {
+      backend_ = std::make_unique<IoUringBackend>(args_.queueDepth);
+    } catch (const std::system_error& e) {
+      DBG("io_uring unavailable, falling back to a thread pool: " +
+          juce::String{e.what()});
+    }
+  }
+#endif
+}
+
+inline WavDataLayout AsyncWavFileReader::read(const juce::File& file,
+                                              const ChunkCallback& onChunk) {
+  const auto layout = readLayout(file);
+  read(file, layout, onChunk);
+  return layout;
+}
+
+inline std::shared_ptr<DecodedAudio> AsyncWavFileReader::decode(
+    const juce::File& file) {
+  const auto layout = readLayout(file);
+  // juce::AudioBuffer holds at most INT_MAX samples per channel
+  if (layout.getLengthInSamples() > std::numeric_limits<int>::max()) {
+    throw std::runtime_error{"File too long to decode into memory: " +
+                             file.getFullPathName().toStdString()};
+  }
+
+  auto decoded = std::make_shared<DecodedAudio>();
+  decoded->sampleRate = layout.sampleRate;
+  decoded->samples.setSize(layout.numChannels,
+                           static_cast<int>(layout.getLengthInSamples()));
+  // fetched once: getWritePointer() is not safe to call concurrently
+  auto* const* channels = decoded->samples.getArrayOfWritePointers();
+
+  read(file, layout, [&](WavDataChunk chunk) {
+    std::vector<float*> destinations(
+        static_cast<std::size_t>(layout.numChannels));
+    for (auto channel = 0; channel < layout.numChannels; ++channel) {
+      destinations[static_cast<std::size_t>(channel)] =
+          channels[channel] + chunk.getStartSample();
+    }
+    chunk.decodeTo(destinations.data());
+  });
+
+  return decoded;
+}
+
+inline WavDataLayout AsyncWavFileReader::readLayout(const juce::File& file) {
+  juce::FileInputStream stream{file};
+  if (stream.failedToOpen()) {
+    throw std::runtime_error{"Could not open file: " +
+                             file.getFullPathName().toStdString()};
+  }
+  return WavDataLayout::readFrom(stream);
+}
+
+inline auto AsyncWavFileReader::chunkGeometryOf(
+    const WavDataLayout& layout) const -> ChunkGeometry {
+  const auto bytesPerFrame =
+      static_cast<std::size_t>(layout.getBytesPerFrame());
+  const auto sizeInBytes =
+      std::max<std::size_t>(1u, args_.chunkSizeInBytes / bytesPerFrame) *
+      bytesPerFrame;
+  const auto size = static_cast<std::int64_t>(sizeInBytes);
+  return {sizeInBytes, (layout.dataSizeInBytes + size - 1) / size};
+}
+
+inline void AsyncWavFileReader::read(const juce::File& file,
+                                     const WavDataLayout& layout,
+                                     const ChunkCallback& onChunk) {
+#if WS_HAS_IO_URING
+  if (backend_ != nullptr) {
+    readWithIoUring(file, layout, onChunk);
+    return;
+  }
+#endif
+  readWithThreadPool(file, layout, onChunk);
+}
+
+inline void AsyncWavFileReader::readWithThreadPool(
+    const juce::File& file,
+    const WavDataLayout& layout,
+    const ChunkCallback& onChunk) {
+  const auto chunks = chunkGeometryOf(layout);
+  const auto numThreads = static_cast<unsigned>(
+      std::min<std::int64_t>(args_.numThreads, chunks.count));
+  detail::ChunkBufferPool buffers{numThreads + args_.maxChunksInPipeline,
+                                  chunks.sizeInBytes};
+
+  std::atomic<std::int64_t> nextChunk{0};
+  std::mutex errorMutex;
+  std::exception_ptr error;
+
+  auto readChunks = [&] {
+    try {
+      juce::FileInputStream stream{file};
+      if (stream.failedToOpen()) {
+        throw std::runtime_error{"Could not open file: " +
+                                 file.getFullPathName().toStdString()};
+      }
+
+      for (auto chunk = nextChunk++; chunk < chunks.count;
+           chunk = nextChunk++) {
+        const auto offset =
+            chunk * static_cast<std::int64_t>(chunks.sizeInBytes);
+        const auto sizeInBytes = static_cast<int>(std::min<std::int64_t>(
+            static_cast<std::int64_t>(chunks.sizeInBytes),
+            layout.dataSizeInBytes - offset));
+
+        auto buffer = buffers.acquire();
+        if (!stream.setPosition(layout.dataOffset + offset)) {
+          throw std::system_error{EIO, std::generic_category(), "seek"};
+        }
+        const auto bytesRead = stream.read(buffer->data(), sizeInBytes);
+        if (bytesRead < 0) {
+          throw std::system_error{EIO, std::generic_category(), "read"};
+        }
+
+        const auto wholeFrames = static_cast<std::size_t>(
+            bytesRead - bytesRead % layout.getBytesPerFrame());
+        onChunk(WavDataChunk{layout, offset / layout.getBytesPerFrame(),
+                             std::move(buffer), wholeFrames});
+      }
+    } catch (...) {
+      // make the other threads run out of chunks
+      nextChunk = chunks.count;
+      const std::scoped_lock lock{errorMutex};
+      if (!error) {
+        error = std::current_exception();
+      }
+    }
+  };
+
+  {
+    std::vector<std::jthread> threads;
+    for (auto i = 1u; i < numThreads; ++i) {
+      threads.emplace_back(readChunks);
+    }
+    readChunks();
+  }
+
+  buffers.waitUntilAllReturned();
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+#if WS_HAS_IO_URING
+inline void AsyncWavFileReader::readWithIoUring(
+    const juce::File& file,
+    const WavDataLayout& layout,
+    const ChunkCallback& onChunk) {
+  const auto fileDescriptor =
+      open(file.getFullPathName().toRawUTF8(), O_RDONLY | O_CLOEXEC);
+  if (fileDescriptor < 0) {
+    throw std::runtime_error{"Could not open file: " +
+                             file.getFullPathName().toStdString()};
+  }
+  const WhenLeavingScopeExecute closeFile{[&] { close(fileDescriptor); }};
+
+  const auto chunks = chunkGeometryOf(layout);
+  const auto queueDepth = std::min(args_.queueDepth, backend_->getNumEntries());
+  // declared before the slots so that it outlives the buffers they hold
+  detail::ChunkBufferPool buffers{queueDepth + args_.maxChunksInPipeline,
+                                  chunks.sizeInBytes};
+
+  struct Slot {
+    std::shared_ptr<std::vector<std::byte>> buffer;
+    iovec vector;
+    std::int64_t offset;
+    std::size_t sizeInBytes;
+    std::size_t bytesRead;
+  };
+  std::vector<Slot> slots(queueDepth);
+  std::vector<std::uint64_t> freeSlots(queueDepth);
+  for (auto i = 0u; i < queueDepth; ++i) {
+    freeSlots[i] = queueDepth - 1u - i;
+  }
+
+  auto submit = [&](std::uint64_t slotIndex) {
+    auto& slot = slots[slotIndex];
+    slot.vector.iov_base = slot.buffer->data() + slot.bytesRead;
+    slot.vector.iov_len = slot.sizeInBytes - slot.bytesRead;
+    backend_->prepareRead(
+        fileDescriptor, &slot.vector,
+        static_cast<std::uint64_t>(layout.dataOffset + slot.offset) +
+            slot.bytesRead,
+        slotIndex);
+  };
+
+  auto complete = [&](std::uint64_t slotIndex) {
+    auto& slot = slots[slotIndex];
+    const auto wholeFrames =
+        slot.bytesRead -
+        slot.bytesRead % static_cast<std::size_t>(layout.getBytesPerFrame());
+    onChunk(WavDataChunk{layout, slot.offset / layout.getBytesPerFrame(),
+                         std::move(slot.buffer), wholeFrames});
+  };
+
+  std::int64_t nextChunk = 0;
+  auto numInFlight = 0u;
+  std::exception_ptr error;
+
+  while (true) {
+    while (!error && numInFlight < queueDepth && nextChunk < chunks.count) {
+      const auto slotIndex = freeSlots.back();
+      freeSlots.pop_back();
+      const auto offset =
+          nextChunk * static_cast<std::int64_t>(chunks.sizeInBytes);
+      slots[slotIndex] = {
+          .buffer = buffers.acquire(),
+          .vector = {},
+          .offset = offset,
+          .sizeInBytes = static_cast<std::size_t>(std::min<std::int64_t>(
+              static_cast<std::int64_t>(chunks.sizeInBytes),
+              layout.dataSizeInBytes - offset)),
+          .bytesRead = 0u};
+      submit(slotIndex);
+      ++numInFlight;
+      ++nextChunk;
+    }
+
+    if (numInFlight == 0u) {
+      break;
+    }
+
+    backend_->submitAndWait(1u);
+    backend_->forEachCompletion([&](const io_uring_cqe& completion) {
+      const auto slotIndex = completion.user_data;
+      auto& slot = slots[slotIndex];
+
+      if (completion.res == -EAGAIN || completion.res == -EINTR) {
+        submit(slotIndex);
+        return;
+      }
+      if (completion.res > 0) {
+        slot.bytesRead += static_cast<std::size_t>(completion.res);
+        if (slot.bytesRead < slot.sizeInBytes) {
+          // short read: request the rest
+          submit(slotIndex);
+          return;
+        }
+      }
+
+      --numInFlight;
+      freeSlots.push_back(slotIndex);
+      if (error) {
+        slot.buffer.reset();
+        return;
+      }
+      try {
+        if (completion.res < 0) {
+          throw std::system_error{-completion.res, std::generic_category(),
+                                  "read"};
+        }
+        // res == 0 means the file is shorter than its header claims
+        complete(slotIndex);
+      } catch (...) {
+        error = std::current_exception();
+      }
+      slot.buffer.reset();
+    });
+  }
+
+  buffers.waitUntilAllReturned();
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+#endif
+}  // namespace wolfsound
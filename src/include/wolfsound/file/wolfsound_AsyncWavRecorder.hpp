@@ -0,0 +1,243 @@
+#pragma once
+
+#include <wolfsound/common/wolfsound_assert.hpp>
+#include <wolfsound/file/wolfsound_StreamingWavFileWriter.hpp>
+#include <juce_core/juce_core.h>
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace wolfsound {
+/** @brief Records blocks from the audio thread to a WAV file on disk.
+ *
+ * push() only copies the block into a preallocated lock-free FIFO
+ * (juce::AbstractFifo) and updates a few atomic counters: it never
+ * allocates, locks, or blocks, so it may be called from the audio callback.
+ * A background thread drains the FIFO into a StreamingWavFileWriter every
+ * drainInterval; it is polled rather than signalled so that the audio
+ * thread never touches a condition variable.
+ *
+ * If the FIFO is full, the whole block is dropped and counted as an
+ * overrun. Use the maximum queue depth from getStatistics() to size the
+ * FIFO: it must hold what the audio thread produces in the longest stall of
+ * the disk.
+ *
+ * @code
+ * // in prepareToPlay()
+ * recorder_ = std::make_unique<AsyncWavRecorder>(AsyncWavRecorder::Args{
+ *     .writer = {.absolutePath = path,
+ *                .sampleRate = Frequency{float(sampleRate)},
+ *                .numChannels = 2}});
+ * // in processBlock()
+ * recorder_->push(buffer);
+ * @endcode
+ */
+class AsyncWavRecorder {
+public:
+  struct Args {
+    StreamingWavFileWriter::Args writer;
+
+    /** @brief FIFO size in samples per channel; one sample of it stays
+     * unused to tell a full FIFO from an empty one. */
+    int fifoSizeInSamples = 1 << 17;
+
+    std::chrono::milliseconds drainInterval{10};
+  };
+
+  struct Statistics {
+    /** @brief Blocks dropped because the FIFO was full. */
+    std::uint64_t overruns = 0u;
+    std::uint64_t droppedSamples = 0u;
+    /** @brief Samples per channel currently waiting in the FIFO. */
+    int queueDepth = 0;
+    /** @brief Highest queueDepth observed right after a push(). */
+    int maxQueueDepth = 0;
+    std::uint64_t samplesWritten = 0u;
+  };
+
+  /** @brief Opens the file and starts the writer thread.
+   *
+   * @throws std::runtime_error if the file cannot be opened
+   */
+  explicit AsyncWavRecorder(Args args);
+
+  AsyncWavRecorder(const AsyncWavRecorder&) = delete;
+  AsyncWavRecorder& operator=(const AsyncWavRecorder&) = delete;
+
+  /** @brief Writes what is still queued and finalizes the file. */
+  ~AsyncWavRecorder();
+
+  /** @brief Queues @p numSamples samples of each of the writer's channels.
+   *
+   * Real-time safe. Returns false if the block was dropped.
+   */
+  bool push(const float* const* channels, int numSamples) noexcept;
+
+  /** @brief Real-time safe; see push(const float* const*, int). */
+  bool push(const juce::AudioBuffer<float>& buffer) noexcept;
+
+  /** @brief Writes what is still queued, finalizes the file, and stops the
+   * writer thread; idempotent. Blocks pushed afterwards are not written.
+   *
+   * @throws std::runtime_error if writing failed on the writer thread
+   */
+  void stop();
+
+  [[nodiscard]] Statistics getStatistics() const noexcept;
+
+private:
+  void runWriterThread();
+  void drain();
+
+  static_assert(std::atomic<std::uint64_t>::is_always_lock_free);
+  static_assert(std::atomic<int>::is_always_lock_free);
+
+  StreamingWavFileWriter writer_;
+  juce::AudioBuffer<float> fifoBuffer_;
+  // fetched once: the AudioBuffer itself is not touched on the audio thread
+  std::vector<float*> fifoChannels_;
+  juce::AbstractFifo fifo_;
+  const std::chrono::milliseconds drainInterval_;
+
+  // touched by the audio thread
+  std::atomic<std::uint64_t> overruns_{0u};
+  std::atomic<std::uint64_t> droppedSamples_{0u};
+  std::atomic<int> maxQueueDepth_{0};
+
+  // touched by the writer thread
+  std::atomic<std::uint64_t> samplesWritten_{0u};
+  std::vector<const float*> drainPointers_;
+  std::exception_ptr writerError_;
+
+  std::mutex stopMutex_;
+  std::condition_variable stopRequested_;
+  bool stopping_ = false;
+  std::thread writerThread_;
+};
+
+inline AsyncWavRecorder::AsyncWavRecorder(Args args)
+    : writer_{std::move(args.writer)},
+      fifoBuffer_{writer_.getNumChannels(), args.fifoSizeInSamples},
+      fifoChannels_(fifoBuffer_.getArrayOfWritePointers(),
+                    fifoBuffer_.getArrayOfWritePointers() +
+                        fifoBuffer_.getNumChannels()),
+      fifo_{args.fifoSizeInSamples},
+      drainInterval_{args.drainInterval},
+      drainPointers_(static_cast<std::size_t>(writer_.getNumChannels())) {
+  WS_PRECONDITION(args.fifoSizeInSamples > 1);
+  writerThread_ = std::thread{[this] { runWriterThread(); }};
+}
+
+inline AsyncWavRecorder::~AsyncWavRecorder() {
+  try {
+    stop();
+  } catch (const std::exception& e) {
+    DBG("Recording failed: " + juce::String{e.what()});
+  }
+}
+
+inline bool AsyncWavRecorder::push(const float* const* channels,
+                                   int numSamples) noexcept {
+  int start1, size1, start2, size2;
+  fifo_.prepareToWrite(numSamples, start1, size1, start2, size2);
+  if (size1 + size2 < numSamples) {
+    // a partial block would leave a discontinuity mid-block; drop it whole
+    overruns_.fetch_add(1u, std::memory_order_relaxed);
+    droppedSamples_.fetch_add(static_cast<std::uint64_t>(numSamples),
+                              std::memory_order_relaxed);
+    return false;
+  }
+
+  for (auto channel = 0u; channel < fifoChannels_.size(); ++channel) {
+    std::copy_n(channels[channel], size1, fifoChannels_[channel] + start1);
+    std::copy_n(channels[channel] + size1, size2,
+                fifoChannels_[channel] + start2);
+  }
+  fifo_.finishedWrite(size1 + size2);
+
+  const auto queueDepth = fifo_.getNumReady();
+  auto maxQueueDepth = maxQueueDepth_.load(std::memory_order_relaxed);
+  while (queueDepth > maxQueueDepth &&
+         !maxQueueDepth_.compare_exchange_weak(maxQueueDepth, queueDepth,
+                                               std::memory_order_relaxed)) {
+  }
+  return true;
+}
+
+inline bool AsyncWavRecorder::push(
+    const juce::AudioBuffer<float>& buffer) noexcept {
+  WS_PRECONDITION(buffer.getNumChannels() ==
+                  static_cast<int>(fifoChannels_.size()));
+  return push(buffer.getArrayOfReadPointers(), buffer.getNumSamples());
+}
+
+inline void AsyncWavRecorder::runWriterThread() {
+  try {
+    std::unique_lock lock{stopMutex_};
+    while (!stopRequested_.wait_for(lock, drainInterval_,
+                                    [this] { return stopping_; })) {
+      lock.unlock();
+      drain();
+      lock.lock();
+    }
+    lock.unlock();
+
+    drain();
+    writer_.close();
+  } catch (...) {
+    // reported by stop(); later pushes will overrun
+    writerError_ = std::current_exception();
+  }
+}
+
+inline void AsyncWavRecorder::drain() {
+  int start1, size1, start2, size2;
+  fifo_.prepareToRead(fifo_.getNumReady(), start1, size1, start2, size2);
+
+  for (const auto& [start, size] :
+       {std::pair{start1, size1}, std::pair{start2, size2}}) {
+    if (size == 0) {
+      continue;
+    }
+    for (auto channel = 0u; channel < fifoChannels_.size(); ++channel) {
+      drainPointers_[channel] = fifoChannels_[channel] + start;
+    }
+    writer_.append(drainPointers_.data(), size);
+  }
+
+  fifo_.finishedRead(size1 + size2);
+  samplesWritten_.fetch_add(static_cast<std::uint64_t>(size1 + size2),
+                            std::memory_order_relaxed);
+}
+
+inline void AsyncWavRecorder::stop() {
+  {
+    const std::scoped_lock lock{stopMutex_};
+    stopping_ = true;
+  }
+  stopRequested_.notify_one();
+
+  if (writerThread_.joinable()) {
+    writerThread_.join();
+    if (writerError_) {
+      std::rethrow_exception(writerError_);
+    }
+  }
+}
+
+inline auto AsyncWavRecorder::getStatistics() const noexcept -> Statistics {
+  return {.overruns = overruns_.load(std::memory_order_relaxed),
+          .droppedSamples = droppedSamples_.load(std::memory_order_relaxed),
+          .queueDepth = fifo_.getNumReady(),
+          .maxQueueDepth = maxQueueDepth_.load(std::memory_order_relaxed),
+          .samplesWritten = samplesWritten_.load(std::memory_order_relaxed)};
+}
+}  // namespace wolfsound
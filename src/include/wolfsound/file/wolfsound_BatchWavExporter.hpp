@@ -0,0 +1,139 @@
+#pragma once
+
+#include <wolfsound/common/wolfsound_Frequency.hpp>
+#include <wolfsound/file/wolfsound_StreamingWavFileWriter.hpp>
+#include <juce_core/juce_core.h>
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <map>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace wolfsound {
+struct WavExportJob {
+  std::string absolutePath;
+  juce::AudioBuffer<float> samples;
+  Frequency sampleRate;
+};
+
+struct WavExportResult {
+  /** @brief The file written, with the ".wav" extension added if missing.
+   */
+  juce::File file;
+  bool succeeded = false;
+  std::string errorMessage;
+};
+
+/** @brief Writes many WAV files concurrently.
+ *
+ * Every output directory is created once, up front, and the jobs are then
+ * spread over a pool of threads, each of which writes whole files with a
+ * StreamingWavFileWriter. A job that fails is reported in its result; the
+ * other jobs are written regardless.
+ *
+ * @code
+ * const auto results = BatchWavExporter{}.exportAll(jobs);
+ * for (const auto& result : results) {
+ *   if (!result.succeeded) {
+ *     std::cerr << result.errorMessage << '\n';
+ *   }
+ * }
+ * @endcode
+ */
+class BatchWavExporter {
+public:
+  struct Args {
+    /** @brief Threads to write on, including the calling one. */
+    unsigned numThreads = std::max(1u, std::thread::hardware_concurrency());
+    WavEncoding encoding = WavEncoding::INT16;
+    /** @brief Passed on to StreamingWavFileWriter::Args::dither. */
+    bool dither = false;
+  };
+
+  BatchWavExporter() : BatchWavExporter{Args{}} {}
+
+  explicit BatchWavExporter(Args args) : args_{args} {}
+
+  /** @brief Writes all @p jobs and blocks until done.
+   *
+   * @return one result per job, in the order of @p jobs
+   */
+  [[nodiscard]] std::vector<WavExportResult> exportAll(
+      std::span<const WavExportJob> jobs) const;
+
+private:
+  void exportOne(const WavExportJob& job, WavExportResult& result) const;
+
+  Args args_;
+};
+
+inline std::vector<WavExportResult> BatchWavExporter::exportAll(
+    std::span<const WavExportJob> jobs) const {
+  std::vector<WavExportResult> results(jobs.size());
+
+  // one attempt per directory; its outcome applies to all files in it
+  std::map<std::string, juce::Result> directories;
+  for (auto i = 0u; i < jobs.size(); ++i) {
+    const juce::File requestedFile{jobs[i].absolutePath};
+    results[i].file = requestedFile.getSiblingFile(detail::sanitizeFilename(
+        requestedFile.getFileName().toStdString()));
+
+    const auto directory = requestedFile.getParentDirectory();
+    auto [entry, inserted] = directories.try_emplace(
+        directory.getFullPathName().toStdString(), juce::Result::ok());
+    if (inserted) {
+      entry->second = directory.createDirectory();
+    }
+    if (entry->second.failed()) {
+      results[i].errorMessage = "Could not create directory " +
+                                directory.getFullPathName().toStdString() +
+                                ": " +
+                                entry->second.getErrorMessage().toStdString();
+    }
+  }
+
+  std::atomic<std::size_t> nextJob{0u};
+  auto exportJobs = [&] {
+    for (auto job = nextJob++; job < jobs.size(); job = nextJob++) {
+      if (results[job].errorMessage.empty()) {
+        exportOne(jobs[job], results[job]);
+      }
+    }
+  };
+
+  {
+    const auto numThreads =
+        std::min<std::size_t>(std::max(1u, args_.numThreads), jobs.size());
+    std::vector<std::jthread> threads;
+    for (auto i = std::size_t{1}; i < numThreads; ++i) {
+      threads.emplace_back(exportJobs);
+    }
+    exportJobs();
+  }
+
+  return results;
+}
+
+inline void BatchWavExporter::exportOne(const WavExportJob& job,
+                                        WavExportResult& result) const {
+  try {
+    StreamingWavFileWriter writer{
+        {.absolutePath = job.absolutePath,
+         .sampleRate = job.sampleRate,
+         .numChannels = job.samples.getNumChannels(),
+         .encoding = args_.encoding,
+         .dither = args_.dither,
+         // exportAll() has created it
+         .createDirectory = false}};
+    writer.append(job.samples);
+    writer.close();
+    result.succeeded = true;
+  } catch (const std::exception& e) {
+    result.errorMessage = e.what();
+  }
+}
+}  // namespace wolfsound
@@ -0,0 +1,246 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+namespace wolfsound {
+/** @brief Sample format in which an audio file has been decoded.
+ *
+ * Integer formats denote the container; samples are right-justified in it
+ * (see PcmBuffer).
+ */
+enum class SampleFormat { FLOAT32, INT16, INT32 };
+
+/** @brief Decoded contents of an audio file.
+ *
+ * Instances are shared read-only between all readers that loaded the same
+ * file, hence they are always handled via std::shared_ptr<const
+ * DecodedAudio>.
+ */
+struct DecodedAudio {
+  juce::AudioBuffer<float> samples;
+  double sampleRate = 0.0;
+
+  [[nodiscard]] std::size_t sizeInBytes() const noexcept {
+    return static_cast<std::size_t>(samples.getNumChannels()) *
+           static_cast<std::size_t>(samples.getNumSamples()) * sizeof(float);
+  }
+};
+
+/** @brief In-process cache of decoded audio files with an LRU byte budget.
+ *
+ * Entries are identified by the file path, its modification time and size,
+ * and the requested sample format, so a file that changed on disk is decoded
+ * anew. Cached buffers are reference-counted: evicting an entry does not
+ * invalidate the buffers that readers still hold.
+ *
+ * Concurrent requests for the same key decode the file only once; the other
+ * callers wait for the result. All member functions are thread-safe.
+ *
+ * @code
+ * auto cache = std::make_shared<DecodedAudioCache>(512u << 20u);
+ * WavFileReader reader{{.cache = cache}};
+ * reader.loadFile(impulseResponseFile);  // decodes
+ * WavFileReader otherReader{{.cache = cache}};
+ * otherReader.loadFile(impulseResponseFile);  // shares the decoded buffer
+ * @endcode
+ */
+class DecodedAudioCache {
+public:
+  struct Key {
+    std::string path;
+    juce::int64 lastModificationTime = 0;
+    juce::int64 fileSize = 0;
+    SampleFormat format = SampleFormat::FLOAT32;
+
+    [[nodiscard]] static Key from(const juce::File& file,
+                                  SampleFormat format = SampleFormat::FLOAT32);
+
+    bool operator==(const Key&) const = default;
+  };
+
+  struct Statistics {
+    std::size_t hits = 0u;
+    std::size_t misses = 0u;
+    std::size_t evictions = 0u;
+    std::size_t entries = 0u;
+    std::size_t sizeInBytes = 0u;
+  };
+
+  using Loader = std::function<std::shared_ptr<const DecodedAudio>()>;
+
+  explicit DecodedAudioCache(std::size_t capacityInBytes)
+      : capacityInBytes_{capacityInBytes} {}
+
+  /** @brief Returns the cached entry for @p key or calls @p load to create it.
+   *
+   * Exceptions thrown by @p load are propagated to every caller waiting for
+   * the given key and nothing is cached.
+   */
+  [[nodiscard]] std::shared_ptr<const DecodedAudio> getOrLoad(
+      const Key& key,
+      const Loader& load);
+
+  /** @brief Returns the cached entry or nullptr; does not change statistics.
+   */
+  [[nodiscard]] std::shared_ptr<const DecodedAudio> find(const Key& key) const;
+
+  /** @brief Drops all entries; buffers held by readers stay valid. */
+  void clear();
+
+  [[nodiscard]] Statistics getStatistics() const;
+
+  [[nodiscard]] std::size_t getCapacityInBytes() const noexcept {
+    return capacityInBytes_;
+  }
+
+private:
+  struct KeyHash {
+    [[nodiscard]] std::size_t operator()(const Key& key) const noexcept;
+  };
+
+  using Value = std::shared_ptr<const DecodedAudio>;
+  using LruList = std::list<std::pair<Key, Value>>;
+
+  void insert(const Key& key, Value value);
+  void evictUntilFits(std::size_t incomingSizeInBytes);
+
+  const std::size_t capacityInBytes_;
+
+  mutable std::mutex mutex_;
+  // most recently used entries are at the front
+  LruList entries_;
+  std::unordered_map<Key, LruList::iterator, KeyHash> index_;
+  std::unordered_map<Key, std::shared_future<Value>, KeyHash> pending_;
+  Statistics statistics_;
+};
+
+inline auto DecodedAudioCache::Key::from(const juce::File& file,
+                                         SampleFormat format) -> Key {
+  return {.path = file.getFullPathName().toStdString(),
+          .lastModificationTime =
+              file.getLastModificationTime().toMilliseconds(),
+          .fileSize = file.getSize(),
+          .format = format};
+}
+
+inline std::size_t DecodedAudioCache::KeyHash::operator()(
+    const Key& key) const noexcept {
+  // hash_combine after boost
+  auto seed = std::hash<std::string>{}(key.path);
+  auto combine = [&seed](std::size_t value) {
+    seed ^= value + 0x9e3779b9u + (seed << 6u) + (seed >> 2u);
+  };
+  combine(std::hash<juce::int64>{}(key.lastModificationTime));
+  combine(std::hash<juce::int64>{}(key.fileSize));
+  combine(static_cast<std::size_t>(key.format));
+  return seed;
+}
+
+inline auto DecodedAudioCache::getOrLoad(const Key& key, const Loader& load)
+    -> Value {
+  std::promise<Value> promise;
+  std::shared_future<Value> loadedByOtherThread;
+
+  {
+    const std::scoped_lock lock{mutex_};
+    if (const auto it = index_.find(key); it != index_.end()) {
+      ++statistics_.hits;
+      entries_.splice(entries_.begin(), entries_, it->second);
+      return it->second->second;
+    }
+
+    if (const auto it = pending_.find(key); it != pending_.end()) {
+      ++statistics_.hits;
+      loadedByOtherThread = it->second;
+    } else {
+      ++statistics_.misses;
+      pending_.emplace(key, promise.get_future().share());
+    }
+  }
+
+  // wait without holding the lock
+  if (loadedByOtherThread.valid()) {
+    return loadedByOtherThread.get();
+  }
+
+  Value value;
+  try {
+    value = load();
+  } catch (...) {
+    const std::scoped_lock lock{mutex_};
+    promise.set_exception(std::current_exception());
+    pending_.erase(key);
+    throw;
+  }
+
+  const std::scoped_lock lock{mutex_};
+  promise.set_value(value);
+  pending_.erase(key);
+  insert(key, value);
+  return value;
+}
+
+inline auto DecodedAudioCache::find(const Key& key) const -> Value {
+  const std::scoped_lock lock{mutex_};
+  if (const auto it = index_.find(key); it != index_.end()) {
+    return it->second->second;
+  }
+  return nullptr;
+}
+
+inline void DecodedAudioCache::clear() {
+  const std::scoped_lock lock{mutex_};
+  entries_.clear();
+  index_.clear();
+  statistics_.entries = 0u;
+  statistics_.sizeInBytes = 0u;
+}
+
+inline auto DecodedAudioCache::getStatistics() const -> Statistics {
+  const std::scoped_lock lock{mutex_};
+  return statistics_;
+}
+
+inline void DecodedAudioCache::insert(const Key& key, Value value) {
+  if (value == nullptr) {
+    return;
+  }
+
+  const auto sizeInBytes = value->sizeInBytes();
+  // entries larger than the whole budget are returned but never cached
+  if (sizeInBytes > capacityInBytes_ || index_.contains(key)) {
+    return;
+  }
+
+  evictUntilFits(sizeInBytes);
+
+  entries_.emplace_front(key, std::move(value));
+  index_.emplace(key, entries_.begin());
+  ++statistics_.entries;
+  statistics_.sizeInBytes += sizeInBytes;
+}
+
+inline void DecodedAudioCache::evictUntilFits(
+    std::size_t incomingSizeInBytes) {
+  while (!entries_.empty() &&
+         statistics_.sizeInBytes + incomingSizeInBytes > capacityInBytes_) {
+    const auto& [leastRecentlyUsedKey, leastRecentlyUsedValue] =
+        entries_.back();
+    statistics_.sizeInBytes -= leastRecentlyUsedValue->sizeInBytes();
+    --statistics_.entries;
+    ++statistics_.evictions;
+    index_.erase(leastRecentlyUsedKey);
+    entries_.pop_back();
+  }
+}
+}  // namespace wolfsound
@@ -0,0 +1,243 @@
+#pragma once
+
+#include <wolfsound/common/wolfsound_Frequency.hpp>
+#include <wolfsound/common/wolfsound_assert.hpp>
+#include <wolfsound/file/wolfsound_DecodedAudioCache.hpp>
+#include <wolfsound/file/wolfsound_createAudioFormatReader.hpp>
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <juce_audio_formats/juce_audio_formats.h>
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <variant>
+#include <vector>
+
+namespace wolfsound {
+/** @brief Planar buffer of integer PCM samples.
+ *
+ * Samples are right-justified in their container, i.e., a 24-bit sample
+ * stored in std::int32_t lies in [-2^23, 2^23 - 1]. All channels share one
+ * contiguous allocation.
+ */
+template <typename SampleType>
+class PcmBuffer {
+public:
+  static_assert(std::is_same_v<SampleType, std::int16_t> ||
+                std::is_same_v<SampleType, std::int32_t>);
+
+  PcmBuffer() = default;
+
+  PcmBuffer(int numChannels, std::size_t numSamples, int bitsPerSample)
+      : numChannels_{numChannels},
+        numSamples_{numSamples},
+        bitsPerSample_{bitsPerSample},
+        samples_(static_cast<std::size_t>(numChannels) * numSamples) {
+    WS_PRECONDITION(numChannels >= 0);
+    WS_PRECONDITION(0 < bitsPerSample &&
+                    bitsPerSample <= static_cast<int>(8 * sizeof(SampleType)));
+  }
+
+  [[nodiscard]] int getNumChannels() const noexcept { return numChannels_; }
+
+  [[nodiscard]] std::size_t getNumSamples() const noexcept {
+    return numSamples_;
+  }
+
+  [[nodiscard]] int getBitsPerSample() const noexcept { return bitsPerSample_; }
+
+  [[nodiscard]] const SampleType* getReadPointer(int channel) const noexcept {
+    WS_PRECONDITION(0 <= channel && channel < numChannels_);
+    return samples_.data() + static_cast<std::size_t>(channel) * numSamples_;
+  }
+
+  [[nodiscard]] SampleType* getWritePointer(int channel) noexcept {
+    WS_PRECONDITION(0 <= channel && channel < numChannels_);
+    return samples_.data() + static_cast<std::size_t>(channel) * numSamples_;
+  }
+
+  [[nodiscard]] std::span<const SampleType> getChannel(int channel) const {
+    return {getReadPointer(channel), numSamples_};
+  }
+
+  [[nodiscard]] std::size_t sizeInBytes() const noexcept {
+    return samples_.size() * sizeof(SampleType);
+  }
+
+private:
+  int numChannels_ = 0;
+  std::size_t numSamples_ = 0u;
+  int bitsPerSample_ = 8 * sizeof(SampleType);
+  std::vector<SampleType> samples_;
+};
+
+/** @brief Converts integer PCM samples to floats in [-1, 1).
+ *
+ * This is a separate step so that callers that only need the integers
+ * (feature extraction, hashing) never pay for the conversion nor for the
+ * twice-as-large float buffer. @p destination is resized if needed.
+ */
+template <typename SampleType>
+void convertToFloat(const PcmBuffer<SampleType>& source,
+                    juce::AudioBuffer<float>& destination) {
+  destination.setSize(source.getNumChannels(),
+                      static_cast<int>(source.getNumSamples()), false, false,
+                      true);
+  const auto scale =
+      1.f / static_cast<float>(1ll << (source.getBitsPerSample() - 1));
+
+  for (auto channel = 0; channel < source.getNumChannels(); ++channel) {
+    const auto* input = source.getReadPointer(channel);
+    auto* output = destination.getWritePointer(channel);
+    if constexpr (std::is_same_v<SampleType, std::int32_t>) {
+      juce::FloatVectorOperations::convertFixedToFloat(
+          output, input, scale, source.getNumSamples());
+    } else {
+      // simple enough for the compiler to vectorize
+      std::transform(input, input + source.getNumSamples(), output,
+                     [scale](SampleType sample) {
+                       return static_cast<float>(sample) * scale;
+                     });
+    }
+  }
+}
+
+/** @brief Reads integer PCM files without expanding the samples to floats.
+ *
+ * Files with up to 16 bits per sample are delivered as std::int16_t, files
+ * with up to 32 bits as std::int32_t (e.g., 24-bit samples as int24 in
+ * int32). Use convertToFloat() if floats are needed after all.
+ *
+ * @code
+ * PcmFileReader reader;
+ * reader.loadFile(file);
+ * if (reader.getSampleFormat() == SampleFormat::INT16) {
+ *   hash(reader.getSamples<std::int16_t>().getChannel(0));
+ * }
+ * @endcode
+ */
+class PcmFileReader {
+public:
+  using Frequency = wolfsound::Frequency;
+
+  /** @throws std::runtime_error if the file cannot be opened or does not
+   * contain integer samples */
+  bool loadFile(const juce::File& file);
+
+  [[nodiscard]] SampleFormat getSampleFormat() const;
+  [[nodiscard]] int getBitsPerSample() const;
+  [[nodiscard]] int getNumChannels() const;
+  [[nodiscard]] Frequency getSampleRate() const;
+  [[nodiscard]] std::size_t getLengthInSamples() const;
+
+  /** @throws std::bad_variant_access if SampleType does not correspond to
+   * getSampleFormat() */
+  template <typename SampleType>
+  [[nodiscard]] const PcmBuffer<SampleType>& getSamples() const {
+    return std::get<PcmBuffer<SampleType>>(samples_);
+  }
+
+private:
+  static constexpr auto CHUNK_SIZE = 1 << 16;
+
+  template <typename SampleType>
+  static PcmBuffer<SampleType> read(juce::AudioFormatReader& reader);
+
+  std::variant<PcmBuffer<std::int16_t>, PcmBuffer<std::int32_t>> samples_;
+  double sampleRate_ = 0.0;
+};
+
+inline bool PcmFileReader::loadFile(const juce::File& file) {
+  const auto reader = createAudioFormatReader(file);
+  if (reader->usesFloatingPointData) {
+    throw std::runtime_error{"File does not contain integer samples: " +
+                             file.getFullPathName().toStdString()};
+  }
+
+  if (reader->bitsPerSample <= 16u) {
+    samples_ = read<std::int16_t>(*reader);
+  } else {
+    samples_ = read<std::int32_t>(*reader);
+  }
+  sampleRate_ = reader->sampleRate;
+
+  DBG("File loaded successfully: " + file.getFullPathName());
+  return true;
+}
+
+template <typename SampleType>
+PcmBuffer<SampleType> PcmFileReader::read(juce::AudioFormatReader& reader) {
+  const auto numChannels = static_cast<int>(reader.numChannels);
+  const auto bitsPerSample = static_cast<int>(reader.bitsPerSample);
+  PcmBuffer<SampleType> result{
+      numChannels, static_cast<std::size_t>(reader.lengthInSamples),
+      bitsPerSample};
+
+  // JUCE delivers integer samples left-justified in 32 bits
+  const auto shift = 32 - bitsPerSample;
+
+  // 32-bit containers are filled in place, 16-bit ones through a small
+  // scratch buffer; either way no full-length intermediate copy is made
+  std::vector<std::int32_t> scratch;
+  if constexpr (std::is_same_v<SampleType, std::int16_t>) {
+    scratch.resize(static_cast<std::size_t>(numChannels) * CHUNK_SIZE);
+  }
+  std::vector<int*> destinations(static_cast<std::size_t>(numChannels));
+
+  for (juce::int64 start = 0; start < reader.lengthInSamples;
+       start += CHUNK_SIZE) {
+    const auto chunkLength = static_cast<int>(
+        std::min<juce::int64>(CHUNK_SIZE, reader.lengthInSamples - start));
+
+    for (auto channel = 0; channel < numChannels; ++channel) {
+      if constexpr (std::is_same_v<SampleType, std::int16_t>) {
+        destinations[static_cast<std::size_t>(channel)] =
+            scratch.data() + static_cast<std::size_t>(channel) * CHUNK_SIZE;
+      } else {
+        destinations[static_cast<std::size_t>(channel)] =
+            result.getWritePointer(channel) + start;
+      }
+    }
+
+    reader.read(destinations.data(), numChannels, start, chunkLength, false);
+
+    for (auto channel = 0; channel < numChannels; ++channel) {
+      const auto* input = destinations[static_cast<std::size_t>(channel)];
+      auto* output = result.getWritePointer(channel) + start;
+      std::transform(input, input + chunkLength, output,
+                     [shift](std::int32_t sample) {
+                       return static_cast<SampleType>(sample >> shift);
+                     });
+    }
+  }
+
+  return result;
+}
+
+inline SampleFormat PcmFileReader::getSampleFormat() const {
+  return std::holds_alternative<PcmBuffer<std::int16_t>>(samples_)
+             ? SampleFormat::INT16
+             : SampleFormat::INT32;
+}
+
+inline int PcmFileReader::getBitsPerSample() const {
+  return std::visit(
+      [](const auto& buffer) { return buffer.getBitsPerSample(); }, samples_);
+}
+
+inline int PcmFileReader::getNumChannels() const {
+  return std::visit([](const auto& buffer) { return buffer.getNumChannels(); },
+                    samples_);
+}
+
+inline auto PcmFileReader::getSampleRate() const -> Frequency {
+  return Frequency{static_cast<float>(sampleRate_)};
+}
+
+inline std::size_t PcmFileReader::getLengthInSamples() const {
+  return std::visit([](const auto& buffer) { return buffer.getNumSamples(); },
+                    samples_);
+}
+}  // namespace wolfsound
@@ -0,0 +1,249 @@
+#pragma once
+
+#include <wolfsound/file/wolfsound_DecodedAudioCache.hpp>
+#include <juce_core/juce_core.h>
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+namespace wolfsound {
+/** @brief Raw, memory-mappable file with the decoded samples of an audio file.
+ *
+ * The file starts with a 64-byte header followed by planar float32 samples
+ * in native byte order. Every channel starts at a 64-byte boundary so a
+ * mapped file can be referred to directly by a juce::AudioBuffer: loading
+ * costs only the page faults of the samples that are actually accessed.
+ *
+ * The header identifies the source audio file by its size, modification time
+ * and a 64-bit FNV-1a hash of its contents. If only the modification time
+ * changed (e.g., after a fresh checkout), the content hash decides whether
+ * the cache file is still valid.
+ *
+ * Cache files are meant to be local to one machine, they are not an
+ * exchange format.
+ */
+class SampleCacheFile {
+public:
+  static constexpr auto FILE_EXTENSION = ".wssc";
+
+  /** @brief Returns the decoded samples of @p sourceFile from
+   * @p cacheFile or nullptr if the cache file is missing or stale.
+   *
+   * The returned buffer refers to read-only mapped memory.
+   */
+  [[nodiscard]] static std::shared_ptr<const DecodedAudio> load(
+      const juce::File& cacheFile,
+      const juce::File& sourceFile);
+
+  /** @brief Stores @p decodedAudio of @p sourceFile in @p cacheFile.
+   *
+   * The file is written to a temporary file first and then moved into place
+   * so that concurrent readers never see partially written data.
+   *
+   * @throws std::runtime_error if the file could not be written
+   */
+  static void write(const juce::File& cacheFile,
+                    const juce::File& sourceFile,
+                    const DecodedAudio& decodedAudio);
+
+  [[nodiscard]] static std::uint64_t contentHashOf(const juce::File& file);
+
+private:
+  static constexpr std::array<char, 4> MAGIC{'W', 'S', 'S', 'C'};
+  static constexpr std::uint32_t VERSION = 1u;
+  static constexpr std::size_t ALIGNMENT = 64u;
+
+  struct Header {
+    std::array<char, 4> magic;
+    std::uint32_t version;
+    std::uint32_t numChannels;
+    std::uint32_t reserved;
+    std::int64_t numSamples;
+    double sampleRate;
+    std::int64_t sourceFileSize;
+    std::int64_t sourceModificationTime;
+    std::uint64_t sourceContentHash;
+    std::array<std::byte, 8> padding;
+  };
+  static_assert(sizeof(Header) == ALIGNMENT);
+
+  [[nodiscard]] static std::size_t channelStrideInBytes(
+      std::int64_t numSamples) noexcept {
+    const auto sizeInBytes =
+        static_cast<std::size_t>(numSamples) * sizeof(float);
+    return (sizeInBytes + ALIGNMENT - 1u) / ALIGNMENT * ALIGNMENT;
+  }
+
+  [[nodiscard]] static std::int64_t expectedFileSize(
+      const Header& header) noexcept {
+    return static_cast<std::int64_t>(
+        sizeof(Header) +
+        header.numChannels * channelStrideInBytes(header.numSamples));
+  }
+
+  [[nodiscard]] static bool isValidFor(Header& header,
+                                       const juce::File& cacheFile,
+                                       const juce::File& sourceFile);
+};
+
+/** @brief DecodedAudio whose samples live in a memory-mapped cache file. */
+struct MappedDecodedAudio : DecodedAudio {
+  std::unique_ptr<juce::MemoryMappedFile> mappedFile;
+};
+
+inline std::uint64_t SampleCacheFile::contentHashOf(const juce::File& file) {
+  juce::FileInputStream input{file};
+  if (input.failedToOpen()) {
+    throw std::runtime_error{"failed to open " +
+                             file.getFullPathName().toStdString()};
+  }
+
+  constexpr auto FNV_OFFSET_BASIS = 14695981039346656037ull;
+  constexpr auto FNV_PRIME = 1099511628211ull;
+  constexpr auto CHUNK_SIZE = 1 << 20;
+
+  auto hash = FNV_OFFSET_BASIS;
+  std::vector<unsigned char> chunk(CHUNK_SIZE);
+  for (auto bytesRead = input.read(chunk.data(), CHUNK_SIZE); bytesRead > 0;
+       bytesRead = input.read(chunk.data(), CHUNK_SIZE)) {
+    for (const auto byte :
+         std::span{chunk}.first(static_cast<std::size_t>(bytesRead))) {
+      hash ^= byte;
+      hash *= FNV_PRIME;
+    }
+  }
+  return hash;
+}
+
+inline bool SampleCacheFile::isValidFor(Header& header,
+                                        const juce::File& cacheFile,
+                                        const juce::File& sourceFile) {
+  if (header.magic != MAGIC || header.version != VERSION ||
+      expectedFileSize(header) != cacheFile.getSize() ||
+      header.sourceFileSize != sourceFile.getSize()) {
+    return false;
+  }
+
+  const auto modificationTime =
+      sourceFile.getLastModificationTime().toMilliseconds();
+  if (header.sourceModificationTime == modificationTime) {
+    return true;
+  }
+
+  if (header.sourceContentHash != contentHashOf(sourceFile)) {
+    return false;
+  }
+
+  // Same contents, new timestamp: remember it to skip hashing next time.
+  // This is an optimization only, so failures are ignored.
+  header.sourceModificationTime = modificationTime;
+  juce::FileOutputStream output{cacheFile};
+  if (output.openedOk() && output.setPosition(0)) {
+    output.write(&header, sizeof(Header));
+  }
+  return true;
+}
+
+inline std::shared_ptr<const DecodedAudio> SampleCacheFile::load(
+    const juce::File& cacheFile,
+    const juce::File& sourceFile) {
+  if (!cacheFile.existsAsFile() || !sourceFile.existsAsFile()) {
+    return nullptr;
+  }
+
+  Header header{};
+  {
+    juce::FileInputStream input{cacheFile};
+    if (input.failedToOpen() ||
+        input.read(&header, sizeof(Header)) != sizeof(Header)) {
+      return nullptr;
+    }
+  }
+
+  if (!isValidFor(header, cacheFile, sourceFile)) {
+    return nullptr;
+  }
+
+  auto decoded = std::make_shared<MappedDecodedAudio>();
+  decoded->mappedFile = std::make_unique<juce::MemoryMappedFile>(
+      cacheFile, juce::MemoryMappedFile::readOnly);
+  auto* data = static_cast<std::byte*>(decoded->mappedFile->getData());
+  if (data == nullptr ||
+      decoded->mappedFile->getSize() !=
+          static_cast<std::size_t>(expectedFileSize(header))) {
+    return nullptr;
+  }
+
+  const auto stride = channelStrideInBytes(header.numSamples);
+  std::vector<float*> channels(header.numChannels);
+  for (auto channel = 0u; channel < header.numChannels; ++channel) {
+    // The mapping is read-only but juce::AudioBuffer wants non-const
+    // pointers. DecodedAudio is only ever handed out as const, though.
+    channels[channel] = reinterpret_cast<float*>(  // NOLINT
+        data + sizeof(Header) + channel * stride);
+  }
+  decoded->samples.setDataToReferTo(channels.data(),
+                                    static_cast<int>(header.numChannels),
+                                    static_cast<int>(header.numSamples));
+  decoded->sampleRate = header.sampleRate;
+  return decoded;
+}
+
+inline void SampleCacheFile::write(const juce::File& cacheFile,
+                                   const juce::File& sourceFile,
+                                   const DecodedAudio& decodedAudio) {
+  const auto& samples = decodedAudio.samples;
+  const Header header{
+      .magic = MAGIC,
+      .version = VERSION,
+      .numChannels = static_cast<std::uint32_t>(samples.getNumChannels()),
+      .reserved = 0u,
+      .numSamples = samples.getNumSamples(),
+      .sampleRate = decodedAudio.sampleRate,
+      .sourceFileSize = sourceFile.getSize(),
+      .sourceModificationTime =
+          sourceFile.getLastModificationTime().toMilliseconds(),
+      .sourceContentHash = contentHashOf(sourceFile),
+      .padding = {}};
+
+  const auto directoryCreationResult =
+      cacheFile.getParentDirectory().createDirectory();
+  if (directoryCreationResult.failed()) {
+    throw std::runtime_error{
+        directoryCreationResult.getErrorMessage().toStdString()};
+  }
+
+  const juce::TemporaryFile temporaryFile{cacheFile};
+  {
+    juce::FileOutputStream output{temporaryFile.getFile()};
+    if (output.failedToOpen()) {
+      throw std::runtime_error{"failed to open the sample cache file"};
+    }
+
+    const auto sizeInBytes =
+        static_cast<std::size_t>(samples.getNumSamples()) * sizeof(float);
+    const auto paddingInBytes =
+        channelStrideInBytes(samples.getNumSamples()) - sizeInBytes;
+    auto succeeded = output.write(&header, sizeof(Header));
+    for (auto channel = 0; channel < samples.getNumChannels(); ++channel) {
+      succeeded = succeeded &&
+                  output.write(samples.getReadPointer(channel), sizeInBytes) &&
+                  output.writeRepeatedByte(0, paddingInBytes);
+    }
+    output.flush();
+
+    if (!succeeded) {
+      throw std::runtime_error{"failed to write the sample cache file"};
+    }
+  }
+
+  if (!temporaryFile.overwriteTargetFileWithTemporary()) {
+    throw std::runtime_error{"failed to move the sample cache file in place"};
+  }
+}
+}  // namespace wolfsound
@@ -0,0 +1,336 @@
+#pragma once
+
+#include <wolfsound/common/wolfsound_Frequency.hpp>
+#include <wolfsound/common/wolfsound_assert.hpp>
+#include <wolfsound/dsp/wolfsound_FloatToPcmConverter.hpp>
+#include <juce_core/juce_core.h>
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <juce_audio_formats/juce_audio_formats.h>
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace wolfsound {
+/** @brief Sample encoding of written WAV files. */
+enum class WavEncoding { INT16, INT24, FLOAT32 };
+
+/** @brief Container of WAV files with more than 4 GB of samples. */
+enum class WavLargeFileFormat { RF64, BW64 };
+
+/** @brief Planar float block such as juce::dsp::AudioBlock<float>; lets the
+ * writers accept blocks without depending on juce_dsp. */
+template <typename Block>
+concept PlanarFloatBlock = requires(const Block& block, std::size_t channel) {
+  { block.getNumChannels() } -> std::convertible_to<std::size_t>;
+  { block.getNumSamples() } -> std::convertible_to<std::size_t>;
+  { block.getChannelPointer(channel) } -> std::convertible_to<const float*>;
+};
+
+namespace detail {
+template <typename SampleType>
+class PtrArrayVectorWrapper {
+public:
+  explicit PtrArrayVectorWrapper(
+      juce::Span<const SampleType> singleChannelSamples)
+      : singleChannelSamples_{singleChannelSamples},
+        ptr_{singleChannelSamples_.data()} {}
+
+  [[nodiscard]] const float* const* ptrArray() const noexcept { return &ptr_; }
+
+private:
+  juce::Span<const SampleType> singleChannelSamples_;
+  const SampleType* ptr_;
+};
+
+[[nodiscard]] inline juce::AudioFormatWriterOptions writerOptionsFor(
+    double sampleRate,
+    int numChannels,
+    WavEncoding encoding) {
+  const auto options = juce::AudioFormatWriterOptions{}
+                           .withSampleRate(sampleRate)
+                           .withNumChannels(numChannels)
+                           .withQualityOptionIndex(0);
+  switch (encoding) {
+    case WavEncoding::INT24:
+      return options.withBitsPerSample(24);
+    case WavEncoding::FLOAT32:
+      return options.withBitsPerSample(32).withSampleFormat(
+          juce::AudioFormatWriterOptions::SampleFormat::floatingPoint);
+    case WavEncoding::INT16:
+    default:
+      return options.withBitsPerSample(16);
+  }
+}
+
+/** @brief Renames an RF64 file to BW64, which only differs in the ID. */
+inline void markRf64AsBw64(const juce::File& file) noexcept {
+  {
+    juce::FileInputStream input{file};
+    char id[4]{};
+    if (!input.openedOk() || input.read(id, 4) != 4 ||
+        std::memcmp(id, "RF64", 4u) != 0) {
+      return;
+    }
+  }
+
+  juce::FileOutputStream output{file};
+  if (output.openedOk() && output.setPosition(0)) {
+    output.write("BW64", 4u);
+  }
+}
+
+inline std::string sanitizeFilename(std::string filename) {
+  if (!filename.ends_with(".wav")) {
+    filename += ".wav";
+  }
+
+  return filename;
+}
+}  // namespace detail
+
+/** @brief Writes a WAV file incrementally, block after block.
+ *
+ * The file is opened once on construction; append() passes every block
+ * straight on to the file, so memory use does not grow with the length of
+ * the capture. The header is finalized on close() or destruction, and
+ * flush() makes everything appended so far readable in between.
+ *
+ * Multichannel samples are passed on as planar channel pointers; the
+ * interleaving happens in JUCE's writer, block by block. Integer encodings
+ * are converted by FloatToPcmConverter. Samples are rounded to the nearest
+ * integer unless Args::dither adds TPDF dither, so that writing is
+ * deterministic by default.
+ *
+ * Files stay single files past the 4 GB limit of RIFF: JUCE's writer
+ * reserves room for a ds64 chunk up front and, when the header is
+ * finalized, turns it into RF64 if the data no longer fits in 32 bits.
+ * Args::largeFileFormat picks BW64 instead; WavFileReader, PcmFileReader,
+ * and AsyncWavFileReader read both. Defining JUCE_WAV_DO_NOT_PAD_HEADER_SIZE
+ * breaks this.
+ *
+ * @code
+ * StreamingWavFileWriter writer{{.absolutePath = path,
+ *                                .sampleRate = 48000_Hz}};
+ * for (auto& block : render()) {
+ *   writer.append(juce::Span{block});
+ * }
+ * writer.close();
+ * @endcode
+ */
+class StreamingWavFileWriter {
+public:
+  using Frequency = wolfsound::Frequency;
+
+  struct Args {
+    std::string absolutePath;
+    Frequency sampleRate;
+    int numChannels = 1;
+    WavEncoding encoding = WavEncoding::INT16;
+    /** @brief Adds TPDF dither before rounding; ignored for
+     * WavEncoding::FLOAT32. */
+    bool dither = false;
+    /** @brief Ignored for WavEncoding::FLOAT32. */
+    FloatToPcmConverter::NoiseShaping noiseShaping =
+        FloatToPcmConverter::NoiseShaping::NONE;
+    /** @brief Used only once the data exceeds 4 GB. */
+    WavLargeFileFormat largeFileFormat = WavLargeFileFormat::RF64;
+    /** @brief If false, the directory of absolutePath must already exist,
+     * which saves file system calls when writing many files into it. */
+    bool createDirectory = true;
+  };
+
+  /** @throws std::runtime_error if the file cannot be opened */
+  explicit StreamingWavFileWriter(Args);
+
+  StreamingWavFileWriter(StreamingWavFileWriter&&) noexcept = default;
+  StreamingWavFileWriter& operator=(StreamingWavFileWriter&&) noexcept =
+      default;
+
+  ~StreamingWavFileWriter() { close(); }
+
+  /** @brief Appends samples of a single-channel file. */
+  template <typename SampleType>
+  void append(juce::Span<const SampleType> samples);
+
+  /** @brief Appends @p numSamples samples of each of getNumChannels()
+   * @p channels. */
+  void append(const float* const* channels, int numSamples);
+
+  /** @brief Appends all samples of a buffer with getNumChannels() channels.
+   */
+  void append(const juce::AudioBuffer<float>& buffer);
+
+  /** @brief Appends all samples of, e.g., a juce::dsp::AudioBlock<float>. */
+  template <PlanarFloatBlock Block>
+  void append(const Block& block);
+
+  /** @brief Updates the header so that the file is valid as it is now. */
+  void flush();
+
+  /** @brief Finalizes the header and closes the file; idempotent. */
+  void close() noexcept;
+
+  [[nodiscard]] bool isOpen() const noexcept { return writer_ != nullptr; }
+  [[nodiscard]] int getNumChannels() const noexcept { return numChannels_; }
+  [[nodiscard]] std::int64_t getNumSamplesWritten() const noexcept {
+    return numSamplesWritten_;
+  }
+  [[nodiscard]] const juce::File& getFile() const noexcept { return file_; }
+
+private:
+  static constexpr auto CONVERSION_BLOCK_SIZE = 4096;
+
+  void appendConverted(const float* const* channels, int numSamples);
+
+  juce::File file_;
+  int numChannels_;
+  WavLargeFileFormat largeFileFormat_;
+  std::unique_ptr<juce::AudioFormatWriter> writer_;
+  std::int64_t numSamplesWritten_ = 0;
+
+  // empty for WavEncoding::FLOAT32
+  std::optional<FloatToPcmConverter> converter_;
+  std::vector<std::vector<std::int32_t>> convertedChannels_;
+  // zero-terminated, as juce::AudioFormatWriter::write() expects
+  std::vector<const int*> convertedPointers_;
+  // channel pointers of the block passed to append(), so that no samples
+  // are copied
+  std::vector<const float*> blockPointers_;
+};
+
+inline StreamingWavFileWriter::StreamingWavFileWriter(Args args)
+    : numChannels_{args.numChannels},
+      largeFileFormat_{args.largeFileFormat} {
+  WS_PRECONDITION(args.numChannels > 0);
+
+  const juce::File requestedFile{args.absolutePath};
+  juce::File outputDirectory{requestedFile.getParentDirectory()};
+  file_ = outputDirectory.getChildFile(
+      detail::sanitizeFilename(requestedFile.getFileName().toStdString()));
+
+  if (args.createDirectory) {
+    const auto directoryCreationResult = outputDirectory.createDirectory();
+    WS_ASSERT(directoryCreationResult.ok(),
+              directoryCreationResult.getErrorMessage().toStdString().c_str());
+
+    // if the file is in a directory that must be created, do it first
+    file_.create();
+  }
+
+  auto openAndTruncateFile =
+      [](const juce::File& file) -> std::unique_ptr<juce::OutputStream> {
+    auto outStream = std::make_unique<juce::FileOutputStream>(file);
+
+    if (outStream->failedToOpen()) {
+      throw std::runtime_error{"failed to open the file for writing"};
+    }
+    outStream->setPosition(0);
+    outStream->truncate();
+    return outStream;
+  };
+
+  auto outStream = openAndTruncateFile(file_);
+  juce::WavAudioFormat wavFormat;
+  writer_ = wavFormat.createWriterFor(
+      outStream,
+      detail::writerOptionsFor(static_cast<double>(args.sampleRate.value()),
+                               numChannels_, args.encoding));
+  if (writer_ == nullptr) {
+    throw std::runtime_error{"failed to initialize WAV file writer"};
+  }
+  outStream.release();  // NOLINT: if we got here, JUCE will delete the stream
+
+  if (args.encoding != WavEncoding::FLOAT32) {
+    converter_.emplace(FloatToPcmConverter::Args{
+        .bitsPerSample = args.encoding == WavEncoding::INT24 ? 24 : 16,
+        .numChannels = numChannels_,
+        .dither = args.dither,
+        .noiseShaping = args.noiseShaping});
+    convertedChannels_.assign(
+        static_cast<std::size_t>(numChannels_),
+        std::vector<std::int32_t>(CONVERSION_BLOCK_SIZE));
+    convertedPointers_.assign(static_cast<std::size_t>(numChannels_) + 1u,
+                              nullptr);
+  }
+  blockPointers_.assign(static_cast<std::size_t>(numChannels_), nullptr);
+}
+
+template <typename SampleType>
+void StreamingWavFileWriter::append(juce::Span<const SampleType> samples) {
+  WS_PRECONDITION(numChannels_ == 1);
+  detail::PtrArrayVectorWrapper wrapper{samples};
+  append(wrapper.ptrArray(), static_cast<int>(samples.size()));
+}
+
+inline void StreamingWavFileWriter::append(const float* const* channels,
+                                           int numSamples) {
+  WS_PRECONDITION(isOpen());
+  if (converter_) {
+    appendConverted(channels, numSamples);
+  } else if (!writer_->writeFromFloatArrays(channels, numChannels_,
+                                            numSamples)) {
+    throw std::runtime_error{"failed to write samples to " +
+                             file_.getFullPathName().toStdString()};
+  }
+  numSamplesWritten_ += numSamples;
+}
+
+inline void StreamingWavFileWriter::appendConverted(
+    const float* const* channels,
+    int numSamples) {
+  for (auto start = 0; start < numSamples; start += CONVERSION_BLOCK_SIZE) {
+    const auto blockSize = std::min(CONVERSION_BLOCK_SIZE, numSamples - start);
+    for (auto channel = 0; channel < numChannels_; ++channel) {
+      auto& converted = convertedChannels_[static_cast<std::size_t>(channel)];
+      converter_->convert(channels[channel] + start, converted.data(),
+                          blockSize, channel);
+      convertedPointers_[static_cast<std::size_t>(channel)] = converted.data();
+    }
+    if (!writer_->write(convertedPointers_.data(), blockSize)) {
+      throw std::runtime_error{"failed to write samples to " +
+                               file_.getFullPathName().toStdString()};
+    }
+  }
+}
+
+inline void StreamingWavFileWriter::append(
+    const juce::AudioBuffer<float>& buffer) {
+  WS_PRECONDITION(buffer.getNumChannels() == numChannels_);
+  append(buffer.getArrayOfReadPointers(), buffer.getNumSamples());
+}
+
+template <PlanarFloatBlock Block>
+void StreamingWavFileWriter::append(const Block& block) {
+  WS_PRECONDITION(static_cast<int>(block.getNumChannels()) == numChannels_);
+  for (auto channel = 0u; channel < blockPointers_.size(); ++channel) {
+    blockPointers_[channel] = block.getChannelPointer(channel);
+  }
+  append(blockPointers_.data(), static_cast<int>(block.getNumSamples()));
+}
+
+inline void StreamingWavFileWriter::flush() {
+  WS_PRECONDITION(isOpen());
+  if (!writer_->flush()) {
+    throw std::runtime_error{"failed to flush " +
+                             file_.getFullPathName().toStdString()};
+  }
+}
+
+inline void StreamingWavFileWriter::close() noexcept {
+  if (writer_ == nullptr) {
+    return;
+  }
+
+  writer_.reset();
+  if (largeFileFormat_ == WavLargeFileFormat::BW64) {
+    detail::markRf64AsBw64(file_);
+  }
+}
+}  // namespace wolfsound
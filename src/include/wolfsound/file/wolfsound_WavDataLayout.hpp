@@ -0,0 +1,256 @@
+#pragma once
+
+#include <wolfsound/common/wolfsound_assert.hpp>
+#include <juce_core/juce_core.h>
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+namespace wolfsound {
+/** @brief Location and encoding of the samples in a WAV file.
+ *
+ * This is all that is needed to read the data chunk with plain file I/O,
+ * bypassing juce::AudioFormatReader: samples are interleaved little-endian
+ * frames of getBytesPerFrame() bytes starting at dataOffset.
+ */
+struct WavDataLayout {
+  int numChannels = 0;
+  double sampleRate = 0.0;
+  int bitsPerSample = 0;
+  bool isFloatingPoint = false;
+  std::int64_t dataOffset = 0;
+  std::int64_t dataSizeInBytes = 0;
+
+  [[nodiscard]] int getBytesPerFrame() const noexcept {
+    return numChannels * (bitsPerSample / 8);
+  }
+
+  [[nodiscard]] std::int64_t getLengthInSamples() const noexcept {
+    return getBytesPerFrame() == 0 ? 0 : dataSizeInBytes / getBytesPerFrame();
+  }
+
+  /** @brief Parses the RIFF, RF64, or BW64 header up to the start of the
+   * data chunk.
+   *
+   * Supports 8-, 16-, 24-, and 32-bit integer and 32- and 64-bit float
+   * samples, also in WAVE_FORMAT_EXTENSIBLE files. The data size of RF64 and
+   * BW64 files, which may exceed 4 GB, is taken from their ds64 chunk. A
+   * data chunk that claims more bytes than the file has is truncated to the
+   * file size.
+   *
+   * @throws std::runtime_error if @p stream is not a supported WAV file
+   */
+  [[nodiscard]] static WavDataLayout readFrom(juce::InputStream& stream);
+
+  /** @brief Converts whole interleaved frames to planar floats in [-1, 1).
+   *
+   * Writes bytes.size() / getBytesPerFrame() samples to each of the
+   * numChannels @p destinationChannels.
+   */
+  void decode(std::span<const std::byte> bytes,
+              float* const* destinationChannels) const;
+};
+
+namespace detail {
+template <typename T>
+[[nodiscard]] T readLittleEndian(const std::byte* bytes) noexcept {
+  static_assert(std::is_trivially_copyable_v<T>);
+  if constexpr (std::endian::native == std::endian::little) {
+    T value;
+    std::memcpy(&value, bytes, sizeof(T));
+    return value;
+  } else {
+    std::array<std::byte, sizeof(T)> reversed;
+    for (auto i = 0u; i < sizeof(T); ++i) {
+      reversed[i] = bytes[sizeof(T) - 1u - i];
+    }
+    return std::bit_cast<T>(reversed);
+  }
+}
+
+template <std::size_t Size>
+void readExactly(juce::InputStream& stream, std::array<std::byte, Size>& out) {
+  if (stream.read(out.data(), static_cast<int>(Size)) !=
+      static_cast<int>(Size)) {
+    throw std::runtime_error{"Unexpected end of WAV header"};
+  }
+}
+
+[[nodiscard]] inline bool hasId(const std::byte* bytes, const char* id) {
+  return std::memcmp(bytes, id, 4u) == 0;
+}
+}  // namespace detail
+
+inline WavDataLayout WavDataLayout::readFrom(juce::InputStream& stream) {
+  constexpr std::uint16_t WAVE_FORMAT_PCM = 0x0001;
+  constexpr std::uint16_t WAVE_FORMAT_IEEE_FLOAT = 0x0003;
+  constexpr std::uint16_t WAVE_FORMAT_EXTENSIBLE = 0xFFFE;
+
+  // chunk sizes that do not fit in 32 bits are stored in the ds64 chunk
+  constexpr std::uint32_t SIZE_IN_DS64 = 0xFFFFFFFF;
+
+  std::array<std::byte, 12> riffHeader;
+  detail::readExactly(stream, riffHeader);
+  // BW64 (ITU-R BS.2088) is RF64 (EBU Tech 3306) under another name
+  const auto is64Bit = detail::hasId(riffHeader.data(), "RF64") ||
+                       detail::hasId(riffHeader.data(), "BW64");
+  if (!(is64Bit || detail::hasId(riffHeader.data(), "RIFF")) ||
+      !detail::hasId(riffHeader.data() + 8, "WAVE")) {
+    throw std::runtime_error{"Not a RIFF WAVE stream"};
+  }
+
+  WavDataLayout layout;
+  auto formatFound = false;
+  std::int64_t dataSizeFromDs64 = -1;
+
+  while (true) {
+    std::array<std::byte, 8> chunkHeader;
+    detail::readExactly(stream, chunkHeader);
+    const auto chunkSize =
+        detail::readLittleEndian<std::uint32_t>(chunkHeader.data() + 4);
+
+    if (detail::hasId(chunkHeader.data(), "fmt ")) {
+      if (chunkSize < 16u) {
+        throw std::runtime_error{"WAV fmt chunk too short"};
+      }
+      std::array<std::byte, 16> format;
+      detail::readExactly(stream, format);
+      auto formatTag = detail::readLittleEndian<std::uint16_t>(format.data());
+      layout.numChannels =
+          detail::readLittleEndian<std::uint16_t>(format.data() + 2);
+      layout.sampleRate =
+          detail::readLittleEndian<std::uint32_t>(format.data() + 4);
+      layout.bitsPerSample =
+          detail::readLittleEndian<std::uint16_t>(format.data() + 14);
+
+      if (formatTag == WAVE_FORMAT_EXTENSIBLE && chunkSize >= 40u) {
+        // cbSize, wValidBitsPerSample, dwChannelMask, then the sub-format
+        // GUID whose first two bytes are the actual format tag
+        std::array<std::byte, 10> extension;
+        detail::readExactly(stream, extension);
+        std::array<std::byte, 2> subFormat;
+        detail::readExactly(stream, subFormat);
+        formatTag = detail::readLittleEndian<std::uint16_t>(subFormat.data());
+        stream.skipNextBytes(chunkSize - 28);
+      } else {
+        stream.skipNextBytes(chunkSize - 16);
+      }
+      stream.skipNextBytes(chunkSize & 1u);
+
+      layout.isFloatingPoint = formatTag == WAVE_FORMAT_IEEE_FLOAT;
+      if (formatTag != WAVE_FORMAT_PCM && !layout.isFloatingPoint) {
+        throw std::runtime_error{"Unsupported WAV format tag: " +
+                                 std::to_string(formatTag)};
+      }
+      formatFound = true;
+    } else if (is64Bit && detail::hasId(chunkHeader.data(), "ds64")) {
+      if (chunkSize < 24u) {
+        throw std::runtime_error{"WAV ds64 chunk too short"};
+      }
+      // RIFF size, data size, and sample count, all 64-bit; then a table of
+      // other oversized chunks, which are not needed here
+      std::array<std::byte, 24> sizes;
+      detail::readExactly(stream, sizes);
+      dataSizeFromDs64 = static_cast<std::int64_t>(
+          detail::readLittleEndian<std::uint64_t>(sizes.data() + 8));
+      stream.skipNextBytes(chunkSize - 24 + (chunkSize & 1u));
+    } else if (detail::hasId(chunkHeader.data(), "data")) {
+      if (!formatFound) {
+        throw std::runtime_error{"WAV data chunk precedes the fmt chunk"};
+      }
+      auto dataSize = static_cast<std::int64_t>(chunkSize);
+      if (is64Bit && chunkSize == SIZE_IN_DS64) {
+        if (dataSizeFromDs64 < 0) {
+          throw std::runtime_error{"WAV ds64 chunk missing"};
+        }
+        dataSize = dataSizeFromDs64;
+      }
+      layout.dataOffset = stream.getPosition();
+      layout.dataSizeInBytes = std::min<std::int64_t>(
+          dataSize, stream.getTotalLength() - layout.dataOffset);
+      break;
+    } else {
+      // chunks are padded to an even size
+      stream.skipNextBytes(chunkSize + (chunkSize & 1u));
+    }
+  }
+
+  const auto supportedInteger =
+      !layout.isFloatingPoint &&
+      (layout.bitsPerSample == 8 || layout.bitsPerSample == 16 ||
+       layout.bitsPerSample == 24 || layout.bitsPerSample == 32);
+  const auto supportedFloat =
+      layout.isFloatingPoint &&
+      (layout.bitsPerSample == 32 || layout.bitsPerSample == 64);
+  if (layout.numChannels <= 0 || !(supportedInteger || supportedFloat)) {
+    throw std::runtime_error{"Unsupported WAV sample encoding: " +
+                             std::to_string(layout.bitsPerSample) +
+                             " bits per sample"};
+  }
+
+  return layout;
+}
+
+inline void WavDataLayout::decode(std::span<const std::byte> bytes,
+                                  float* const* destinationChannels) const {
+  WS_PRECONDITION(getBytesPerFrame() > 0);
+  const auto bytesPerSample = static_cast<std::size_t>(bitsPerSample / 8);
+  const auto bytesPerFrame = static_cast<std::size_t>(getBytesPerFrame());
+  const auto numFrames = bytes.size() / bytesPerFrame;
+
+  auto deinterleave = [&](auto toFloat) {
+    for (auto channel = 0; channel < numChannels; ++channel) {
+      const auto* input =
+          bytes.data() + static_cast<std::size_t>(channel) * bytesPerSample;
+      auto* output = destinationChannels[channel];
+      for (auto frame = std::size_t{0}; frame < numFrames; ++frame) {
+        output[frame] = toFloat(input + frame * bytesPerFrame);
+      }
+    }
+  };
+
+  if (isFloatingPoint && bitsPerSample == 32) {
+    deinterleave([](const std::byte* sample) {
+      return detail::readLittleEndian<float>(sample);
+    });
+  } else if (isFloatingPoint) {
+    deinterleave([](const std::byte* sample) {
+      return static_cast<float>(detail::readLittleEndian<double>(sample));
+    });
+  } else if (bitsPerSample == 8) {
+    // 8-bit WAV samples are unsigned
+    deinterleave([](const std::byte* sample) {
+      return static_cast<float>(std::to_integer<int>(sample[0]) - 128) / 128.f;
+    });
+  } else if (bitsPerSample == 16) {
+    deinterleave([](const std::byte* sample) {
+      return static_cast<float>(
+                 detail::readLittleEndian<std::int16_t>(sample)) /
+             32768.f;
+    });
+  } else if (bitsPerSample == 24) {
+    deinterleave([](const std::byte* sample) {
+      // assemble in the upper 24 bits, then shift arithmetically
+      const auto value = static_cast<std::int32_t>(
+                             (static_cast<std::uint32_t>(sample[0]) << 8u) |
+                             (static_cast<std::uint32_t>(sample[1]) << 16u) |
+                             (static_cast<std::uint32_t>(sample[2]) << 24u)) >>
+                         8;
+      return static_cast<float>(value) / 8388608.f;
+    });
+  } else {
+    deinterleave([](const std::byte* sample) {
+      return static_cast<float>(
+                 detail::readLittleEndian<std::int32_t>(sample)) /
+             2147483648.f;
+    });
+  }
+}
+}  // namespace wolfsound
@@ -1,14 +1,44 @@
 #pragma once
 
 #include <wolfsound/common/wolfsound_Frequency.hpp>
+#include <wolfsound/file/wolfsound_AsyncWavFileReader.hpp>
+#include <wolfsound/file/wolfsound_DecodedAudioCache.hpp>
+#include <wolfsound/file/wolfsound_SampleCacheFile.hpp>
+#include <wolfsound/file/wolfsound_createAudioFormatReader.hpp>
 #include <juce_audio_basics/juce_audio_basics.h>
 #include <juce_audio_formats/juce_audio_formats.h>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <stdexcept>
 
 namespace wolfsound {
 class WavFileReader {
 public:
   using Frequency = wolfsound::Frequency;
 
+  struct Args {
+    /** @brief If set, decoded files are looked up in and stored to it. */
+    std::shared_ptr<DecodedAudioCache> cache = nullptr;
+
+    /** @brief If true, decoded samples are kept in SampleCacheFile sidecars
+     * and later loads map them instead of decoding the file again. */
+    bool useSampleCacheFiles = false;
+
+    /** @brief Where to put the sidecars; if empty, next to the audio files.
+     */
+    juce::File sampleCacheDirectory{};
+
+    /** @brief If set, files are read with an AsyncWavFileReader made with
+     * these arguments, which keeps many reads in flight and decodes chunks
+     * as they arrive. Files it cannot parse are decoded with JUCE. */
+    std::optional<AsyncWavFileReader::Args> asyncReading = std::nullopt;
+  };
+
+  WavFileReader() = default;
+
+  explicit WavFileReader(Args args);
+
   bool loadFile(const juce::File& file);
   [[nodiscard]] int getNumChannels() const;
   [[nodiscard]] Frequency getSampleRate() const;
@@ -17,46 +47,123 @@ public:
   [[nodiscard]] const juce::AudioBuffer<float>& getSamples() const;
 
 private:
-  juce::AudioBuffer<float> audioBuffer_;
-  double sampleRate_ = 0.0;
+  [[nodiscard]] std::shared_ptr<const DecodedAudio> decode(
+      const juce::File& file) const;
+  [[nodiscard]] std::shared_ptr<const DecodedAudio> decodeSamples(
+      const juce::File& file) const;
+  [[nodiscard]] static std::shared_ptr<const DecodedAudio> decodeWithJuce(
+      const juce::File& file);
+  [[nodiscard]] juce::File sampleCacheFileFor(const juce::File& file) const;
+
+  std::shared_ptr<DecodedAudioCache> cache_;
+  bool useSampleCacheFiles_ = false;
+  juce::File sampleCacheDirectory_;
+  std::optional<AsyncWavFileReader::Args> asyncReading_;
+  std::shared_ptr<const DecodedAudio> decodedAudio_ =
+      std::make_shared<const DecodedAudio>();
 };
 
+inline WavFileReader::WavFileReader(Args args)
+    : cache_{std::move(args.cache)},
+      useSampleCacheFiles_{args.useSampleCacheFiles},
+      sampleCacheDirectory_{std::move(args.sampleCacheDirectory)},
+      asyncReading_{std::move(args.asyncReading)} {}
+
 inline bool WavFileReader::loadFile(const juce::File& file) {
-  juce::AudioFormatManager formatManager;
-  formatManager.registerBasicFormats();  // Registers WAV, AIFF, etc.
+  if (cache_ != nullptr) {
+    decodedAudio_ = cache_->getOrLoad(DecodedAudioCache::Key::from(file),
+                                      [&] { return decode(file); });
+  } else {
+    decodedAudio_ = decode(file);
+  }
+
+  DBG("File loaded successfully: " + file.getFullPathName());
+  return true;
+}
+
+inline std::shared_ptr<const DecodedAudio> WavFileReader::decode(
+    const juce::File& file) const {
+  if (!useSampleCacheFiles_) {
+    return decodeSamples(file);
+  }
 
-  std::unique_ptr<juce::AudioFormatReader> reader(
-      formatManager.createReaderFor(file));
+  const auto cacheFile = sampleCacheFileFor(file);
+  if (auto cached = SampleCacheFile::load(cacheFile, file)) {
+    return cached;
+  }
+
+  auto decoded = decodeSamples(file);
+  try {
+    SampleCacheFile::write(cacheFile, file, *decoded);
+  } catch (const std::runtime_error& e) {
+    // the cache is an optimization; failing to write it is not an error
+    DBG("Could not write sample cache file: " + juce::String{e.what()});
+  }
+  return decoded;
+}
+
+inline juce::File WavFileReader::sampleCacheFileFor(
+    const juce::File& file) const {
+  const auto fileName = file.getFileName() + SampleCacheFile::FILE_EXTENSION;
+  if (sampleCacheDirectory_ == juce::File{}) {
+    return file.getSiblingFile(fileName);
+  }
+
+  // prefix with a hash of the path so that equally named files from
+  // different directories do not overwrite each other's cache
+  const auto pathHash = juce::String::toHexString(static_cast<juce::int64>(
+      std::hash<std::string>{}(file.getFullPathName().toStdString())));
+  return sampleCacheDirectory_.getChildFile(pathHash + "_" + fileName);
+}
 
-  if (reader == nullptr) {
-    throw std::runtime_error{"Could not open file: " +
+inline std::shared_ptr<const DecodedAudio> WavFileReader::decodeSamples(
+    const juce::File& file) const {
+  if (!asyncReading_.has_value()) {
+    return decodeWithJuce(file);
+  }
+
+  try {
+    // one reader per file: an AsyncWavFileReader reads one file at a time
+    return AsyncWavFileReader{*asyncReading_}.decode(file);
+  } catch (const std::runtime_error& e) {
+    // e.g., a compressed WAV file, which JUCE may still decode
+    DBG("Could not read the file asynchronously: " + juce::String{e.what()});
+    return decodeWithJuce(file);
+  }
+}
+
+inline std::shared_ptr<const DecodedAudio> WavFileReader::decodeWithJuce(
+    const juce::File& file) {
+  const auto reader = createAudioFormatReader(file);
+  if (reader->lengthInSamples > std::numeric_limits<int>::max()) {
+    throw std::runtime_error{"File too long to decode into memory: " +
                              file.getFullPathName().toStdString()};
-    return false;
   }
 
-  audioBuffer_.setSize(static_cast<int>(reader->numChannels),
-                       static_cast<int>(reader->lengthInSamples));
-  reader->read(&audioBuffer_, 0, audioBuffer_.getNumSamples(), 0, true, true);
+  auto decoded = std::make_shared<DecodedAudio>();
+  decoded->samples.setSize(static_cast<int>(reader->numChannels),
+                           static_cast<int>(reader->lengthInSamples));
+  reader->read(&decoded->samples, 0, decoded->samples.getNumSamples(), 0, true,
+               true);
 
-  sampleRate_ = reader->sampleRate;
+  decoded->sampleRate = reader->sampleRate;
 
-  DBG("File loaded successfully: " + file.getFullPathName());
-  return true;
+  return decoded;
 }
 
 inline int WavFileReader::getNumChannels() const {
-  return audioBuffer_.getNumChannels();
+  return decodedAudio_->samples.getNumChannels();
 }
 
 inline auto WavFileReader::getSampleRate() const -> Frequency {
-  return Frequency{static_cast<float>(sampleRate_)};
+  return Frequency{static_cast<float>(decodedAudio_->sampleRate)};
 }
 
 inline std::size_t WavFileReader::getLengthInSamples() const {
-  return static_cast<std::size_t>(audioBuffer_.getNumSamples());
+  return static_cast<std::size_t>(decodedAudio_->samples.getNumSamples());
 }
 
 inline const juce::AudioBuffer<float>& WavFileReader::getSamples() const {
-  return audioBuffer_;
+  return decodedAudio_->samples;
 }
 }  // namespace wolfsound
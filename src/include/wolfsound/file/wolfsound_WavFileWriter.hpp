@@ -2,12 +2,20 @@
 
 #include <wolfsound/common/wolfsound_Frequency.hpp>
 #include <wolfsound/common/wolfsound_assert.hpp>
+#include <wolfsound/file/wolfsound_StreamingWavFileWriter.hpp>
 #include <juce_core/juce_core.h>
 #include <juce_audio_formats/juce_audio_formats.h>
+#include <string>
+#include <utility>
 #include <vector>
-#include <stdexcept>
 
 namespace wolfsound {
+/** @brief Writes whole signals to WAV files in one go.
+ *
+ * Every write() replaces the file. Multichannel buffers and blocks are
+ * written straight from their planar channels. Use StreamingWavFileWriter
+ * to write a signal block by block.
+ */
 class WavFileWriter {
 public:
   using Frequency = wolfsound::Frequency;
@@ -26,6 +34,13 @@ public:
   struct Args {
     std::string absolutePath;
     Frequency sampleRate;
+    WavEncoding encoding = WavEncoding::INT16;
+    /** @brief Adds TPDF dither before rounding; ignored for
+     * WavEncoding::FLOAT32. */
+    bool dither = false;
+    /** @brief Ignored for WavEncoding::FLOAT32. */
+    FloatToPcmConverter::NoiseShaping noiseShaping =
+        FloatToPcmConverter::NoiseShaping::NONE;
   };
 
   explicit WavFileWriter(Args);
@@ -35,45 +50,22 @@ public:
   template <typename SampleType>
   void write(juce::Span<const SampleType> samples) const;
 
-private:
-  [[nodiscard]] juce::File outputDirectory() const;
-
-  juce::File file_;
-  Frequency sampleRate_;
-};
-
-namespace detail {
-template <typename SampleType>
-class PtrArrayVectorWrapper {
-public:
-  explicit PtrArrayVectorWrapper(
-      juce::Span<const SampleType> singleChannelSamples)
-      : singleChannelSamples_{singleChannelSamples},
-        ptr_{singleChannelSamples_.data()} {}
+  /** @brief Writes a file with buffer.getNumChannels() channels. */
+  void write(const juce::AudioBuffer<float>& buffer) const;
 
-  [[nodiscard]] const float* const* ptrArray() const noexcept { return &ptr_; }
+  /** @brief Writes, e.g., a juce::dsp::AudioBlock<float>. */
+  template <PlanarFloatBlock Block>
+  void write(const Block& block) const;
 
 private:
-  juce::Span<const SampleType> singleChannelSamples_;
-  const SampleType* ptr_;
-};
+  [[nodiscard]] StreamingWavFileWriter open(int numChannels) const;
 
-inline std::string sanitizeFilename(std::string filename) {
-  if (!filename.ends_with(".wav")) {
-    filename += ".wav";
-  }
-
-  return filename;
-}
-}  // namespace detail
-
-inline juce::File WavFileWriter::outputDirectory() const {
-  juce::File outputDirectory{file_.getParentDirectory()};
-  const auto directoryCreationResult = outputDirectory.createDirectory();
-  WS_ASSERT(directoryCreationResult.ok(),
-            directoryCreationResult.getErrorMessage().toStdString().c_str());
-  return outputDirectory;
-}
+  std::string absolutePath_;
+  Frequency sampleRate_;
+  WavEncoding encoding_;
+  bool dither_;
+  FloatToPcmConverter::NoiseShaping noiseShaping_;
+};
 
 inline void WavFileWriter::writeToFile(const std::string& absolutePath,
                                        const std::vector<float>& samples,
@@ -91,7 +83,11 @@ inline void WavFileWriter::writeToFile(const std::string& absolutePath,
 }
 
 inline WavFileWriter::WavFileWriter(Args args)
-    : file_{args.absolutePath}, sampleRate_{args.sampleRate} {}
+    : absolutePath_{std::move(args.absolutePath)},
+      sampleRate_{args.sampleRate},
+      encoding_{args.encoding},
+      dither_{args.dither},
+      noiseShaping_{args.noiseShaping} {}
 
 inline void WavFileWriter::write(const std::vector<float>& samples) const {
   write(juce::Span{samples});
@@ -99,40 +95,24 @@ inline void WavFileWriter::write(const std::vector<float>& samples) const {
 
 template <typename SampleType>
 void WavFileWriter::write(juce::Span<const SampleType> samples) const {
-  const auto filename =
-      detail::sanitizeFilename(file_.getFileName().toStdString());
-  auto outputFile = outputDirectory().getChildFile(filename);
-
-  // if the file is in a directory that must be created, do it first
-  outputFile.create();
-
-  auto openAndTruncateFile =
-      [](const juce::File& file) -> std::unique_ptr<juce::OutputStream> {
-    auto outStream = std::make_unique<juce::FileOutputStream>(file);
-
-    if (outStream->failedToOpen()) {
-      throw std::runtime_error{"failed to open the file for writing"};
-    }
-    outStream->setPosition(0);
-    outStream->truncate();
-    return outStream;
-  };
+  open(1).append(samples);
+}
+
+inline void WavFileWriter::write(const juce::AudioBuffer<float>& buffer) const {
+  open(buffer.getNumChannels()).append(buffer);
+}
+
+template <PlanarFloatBlock Block>
+void WavFileWriter::write(const Block& block) const {
+  open(static_cast<int>(block.getNumChannels())).append(block);
+}
 
-  auto outStream = openAndTruncateFile(outputFile);
-  juce::WavAudioFormat wavFormat;
-  const auto writer = wavFormat.createWriterFor(
-      outStream, juce::AudioFormatWriterOptions{}
-                     .withSampleRate(static_cast<double>(sampleRate_.value()))
-                     .withNumChannels(1)
-                     .withBitsPerSample(16)
-                     .withQualityOptionIndex(0));
-  if (writer == nullptr) {
-    throw std::runtime_error{"failed to initialize WAV file writer"};
-  }
-  outStream.release();  // NOLINT: if we got here, JUCE will delete the stream
-
-  detail::PtrArrayVectorWrapper wrapper{samples};
-  writer->writeFromFloatArrays(wrapper.ptrArray(), 1,
-                               static_cast<int>(samples.size()));
+inline StreamingWavFileWriter WavFileWriter::open(int numChannels) const {
+  return StreamingWavFileWriter{{.absolutePath = absolutePath_,
+                                 .sampleRate = sampleRate_,
+                                 .numChannels = numChannels,
+                                 .encoding = encoding_,
+                                 .dither = dither_,
+                                 .noiseShaping = noiseShaping_}};
 }
 }  // namespace wolfsound
@@ -0,0 +1,555 @@
+#pragma once
+
+#include <wolfsound/common/wolfsound_assert.hpp>
+#include <wolfsound/file/wolfsound_SampleCacheFile.hpp>
+#include <wolfsound/file/wolfsound_createAudioFormatReader.hpp>
+#include <juce_core/juce_core.h>
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <juce_audio_formats/juce_audio_formats.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+namespace wolfsound {
+/** @brief Summary of consecutive samples of one channel. */
+struct OverviewBucket {
+  float min = 0.f;
+  float max = 0.f;
+  float rms = 0.f;
+};
+
+/** @brief Min/max/RMS pyramid of an audio file for drawing waveforms.
+ *
+ * Level 0 summarizes samplesPerBucket samples per bucket; every further
+ * level merges decimationFactor buckets of the level below, up to a level
+ * with a single bucket. The pyramid of a file is about
+ * 12 / (samplesPerBucket - samplesPerBucket / decimationFactor) times the
+ * size of its float samples.
+ *
+ * getPixels() answers any zoom level in time proportional to the number of
+ * pixels because it merges at most decimationFactor + 1 buckets per pixel.
+ *
+ * Overviews are persisted in sidecar files validated like SampleCacheFile.
+ *
+ * @code
+ * const auto overview = WaveformOverview::loadOrBuild(file);
+ * std::vector<OverviewBucket> pixels(width);
+ * overview.getPixels(0, visibleStart, visibleLength, pixels);
+ * @endcode
+ */
+class WaveformOverview {
+public:
+  static constexpr auto FILE_EXTENSION = ".wsov";
+
+  struct Args {
+    /** @brief Samples summarized by one bucket of level 0. */
+    int samplesPerBucket = 256;
+
+    /** @brief Buckets merged into one bucket of the next level. */
+    int decimationFactor = 4;
+  };
+
+  /** @brief Computes an overview from consecutive blocks of samples in a
+   * single pass, e.g., while rendering or recording. */
+  class Builder;
+
+  /** @brief Streams all samples of @p reader through a Builder. */
+  [[nodiscard]] static WaveformOverview build(juce::AudioFormatReader& reader,
+                                              Args args);
+
+  /** @throws std::runtime_error if @p audioFile cannot be opened */
+  [[nodiscard]] static WaveformOverview build(const juce::File& audioFile,
+                                              Args args);
+
+  /** @brief Returns the overview of @p sourceFile stored in
+   * @p overviewFile or std::nullopt if it is missing or stale. */
+  [[nodiscard]] static std::optional<WaveformOverview> load(
+      const juce::File& overviewFile,
+      const juce::File& sourceFile);
+
+  /** @throws std::runtime_error if the file could not be written */
+  void save(const juce::File& overviewFile,
+            const juce::File& sourceFile) const;
+
+  /** @brief Loads the sidecar next to @p audioFile or builds the overview
+   * and stores it there. */
+  [[nodiscard]] static WaveformOverview loadOrBuild(
+      const juce::File& audioFile);
+  [[nodiscard]] static WaveformOverview loadOrBuild(
+      const juce::File& audioFile,
+      Args args);
+
+  [[nodiscard]] int getNumChannels() const noexcept { return numChannels_; }
+  [[nodiscard]] double getSampleRate() const noexcept { return sampleRate_; }
+  [[nodiscard]] std::int64_t getLengthInSamples() const noexcept {
+    return lengthInSamples_;
+  }
+  [[nodiscard]] int getNumLevels() const noexcept {
+    return static_cast<int>(levels_.size());
+  }
+  [[nodiscard]] std::int64_t getSamplesPerBucket(int level) const noexcept;
+
+  [[nodiscard]] std::span<const OverviewBucket> getLevel(int level,
+                                                         int channel) const;
+
+  /** @brief Summarizes @p numSamples samples from @p startSample into
+   * pixels.size() buckets; pixels past the end of the file are zero. */
+  void getPixels(int channel,
+                 std::int64_t startSample,
+                 std::int64_t numSamples,
+                 std::span<OverviewBucket> pixels) const;
+
+private:
+  static constexpr std::array<char, 4> MAGIC{'W', 'S', 'O', 'V'};
+  static constexpr std::uint32_t VERSION = 1u;
+  static constexpr std::uint32_t MAX_NUM_LEVELS = 64u;
+
+  struct Header {
+    std::array<char, 4> magic;
+    std::uint32_t version;
+    std::uint32_t numChannels;
+    std::uint32_t numLevels;
+    std::uint32_t samplesPerBucket;
+    std::uint32_t decimationFactor;
+    std::int64_t lengthInSamples;
+    double sampleRate;
+    std::int64_t sourceFileSize;
+    std::int64_t sourceModificationTime;
+    std::uint64_t sourceContentHash;
+  };
+  static_assert(sizeof(Header) == 64u);
+
+  WaveformOverview() = default;
+
+  [[nodiscard]] std::int64_t getNumBuckets(int level) const noexcept;
+  [[nodiscard]] std::int64_t getNumSamplesIn(int level,
+                                             std::int64_t bucket) const;
+  void buildCoarserLevels();
+
+  int numChannels_ = 0;
+  double sampleRate_ = 0.0;
+  std::int64_t lengthInSamples_ = 0;
+  Args args_;
+  // levels_[level] holds the buckets of all channels, channel after channel
+  std::vector<std::vector<OverviewBucket>> levels_;
+};
+
+class WaveformOverview::Builder {
+public:
+  Builder(int numChannels, double sampleRate, Args args);
+
+  /** @brief Block sizes need not be multiples of samplesPerBucket. */
+  void addBlock(const float* const* channels, int numSamples);
+
+  [[nodiscard]] WaveformOverview finish() &&;
+
+private:
+  struct PendingBucket {
+    float min = std::numeric_limits<float>::max();
+    float max = std::numeric_limits<float>::lowest();
+    double sumOfSquares = 0.0;
+    int numSamples = 0;
+  };
+
+  void accumulate(int channel, const float* samples, int numSamples);
+  void emit(int channel);
+
+  WaveformOverview overview_;
+  std::vector<PendingBucket> pending_;
+  // level 0 per channel until finish() lays it out channel after channel
+  std::vector<std::vector<OverviewBucket>> buckets_;
+};
+
+namespace detail {
+[[nodiscard]] inline double sumOfSquares(const float* samples,
+                                         int numSamples) noexcept {
+  // independent partial sums let the compiler vectorize the loop without
+  // -ffast-math
+  constexpr auto LANES = 8;
+  std::array<float, LANES> partialSums{};
+  auto i = 0;
+  for (; i + LANES <= numSamples; i += LANES) {
+    for (auto lane = 0; lane < LANES; ++lane) {
+      partialSums[lane] += samples[i + lane] * samples[i + lane];
+    }
+  }
+  for (; i < numSamples; ++i) {
+    partialSums[0] += samples[i] * samples[i];
+  }
+
+  auto sum = 0.0;
+  for (const auto partialSum : partialSums) {
+    sum += partialSum;
+  }
+  return sum;
+}
+}  // namespace detail
+
+inline WaveformOverview::Builder::Builder(int numChannels,
+                                          double sampleRate,
+                                          Args args)
+    : pending_(static_cast<std::size_t>(numChannels)),
+      buckets_(static_cast<std::size_t>(numChannels)) {
+  WS_PRECONDITION(numChannels > 0);
+  WS_PRECONDITION(args.samplesPerBucket > 0);
+  WS_PRECONDITION(args.decimationFactor > 1);
+  overview_.numChannels_ = numChannels;
+  overview_.sampleRate_ = sampleRate;
+  overview_.args_ = args;
+}
+
+inline void WaveformOverview::Builder::addBlock(const float* const* channels,
+                                                int numSamples) {
+  for (auto channel = 0; channel < overview_.numChannels_; ++channel) {
+    accumulate(channel, channels[channel], numSamples);
+  }
+  overview_.lengthInSamples_ += numSamples;
+}
+
+inline void WaveformOverview::Builder::accumulate(int channel,
+                                                  const float* samples,
+                                                  int numSamples) {
+  auto& pending = pending_[static_cast<std::size_t>(channel)];
+  while (numSamples > 0) {
+    const auto count = std::min(
+        numSamples, overview_.args_.samplesPerBucket - pending.numSamples);
+    const auto range =
+        juce::FloatVectorOperations::findMinAndMax(samples, count);
+    pending.min = std::min(pending.min, range.getStart());
+    pending.max = std::max(pending.max, range.getEnd());
+    pending.sumOfSquares += detail::sumOfSquares(samples, count);
+    pending.numSamples += count;
+
+    if (pending.numSamples == overview_.args_.samplesPerBucket) {
+      emit(channel);
+    }
+    samples += count;
+    numSamples -= count;
+  }
+}
+
+inline void WaveformOverview::Builder::emit(int channel) {
+  auto& pending = pending_[static_cast<std::size_t>(channel)];
+  buckets_[static_cast<std::size_t>(channel)].push_back(
+      {.min = pending.min,
+       .max = pending.max,
+       .rms = static_cast<float>(
+           std::sqrt(pending.sumOfSquares / pending.numSamples))});
+  pending = {};
+}
+
+inline WaveformOverview WaveformOverview::Builder::finish() && {
+  auto& level = overview_.levels_.emplace_back();
+  for (auto channel = 0; channel < overview_.numChannels_; ++channel) {
+    if (pending_[static_cast<std::size_t>(channel)].numSamples > 0) {
+      emit(channel);
+    }
+    const auto& buckets = buckets_[static_cast<std::size_t>(channel)];
+    level.insert(level.end(), buckets.begin(), buckets.end());
+  }
+  buckets_.clear();
+
+  overview_.buildCoarserLevels();
+  return std::move(overview_);
+}
+
+inline void WaveformOverview::buildCoarserLevels() {
+  const auto factor = args_.decimationFactor;
+
+  while (getNumBuckets(getNumLevels() - 1) > 1) {
+    const auto finerLevel = getNumLevels() - 1;
+    const auto numFinerBuckets = getNumBuckets(finerLevel);
+    const auto numBuckets = getNumBuckets(finerLevel + 1);
+    std::vector<OverviewBucket> level;
+    level.reserve(static_cast<std::size_t>(numChannels_ * numBuckets));
+
+    for (auto channel = 0; channel < numChannels_; ++channel) {
+      const auto finer = getLevel(finerLevel, channel);
+      for (std::int64_t bucket = 0; bucket < numBuckets; ++bucket) {
+        OverviewBucket merged{.min = std::numeric_limits<float>::max(),
+                              .max = std::numeric_limits<float>::lowest()};
+        auto sumOfSquares = 0.0;
+        const auto end = std::min(numFinerBuckets, (bucket + 1) * factor);
+        for (auto child = bucket * factor; child < end; ++child) {
+          const auto& finerBucket = finer[static_cast<std::size_t>(child)];
+          merged.min = std::min(merged.min, finerBucket.min);
+          merged.max = std::max(merged.max, finerBucket.max);
+          sumOfSquares +=
+              static_cast<double>(finerBucket.rms) * finerBucket.rms *
+              static_cast<double>(getNumSamplesIn(finerLevel, child));
+        }
+        const auto numSamples = getNumSamplesIn(finerLevel + 1, bucket);
+        merged.rms = static_cast<float>(
+            std::sqrt(sumOfSquares / static_cast<double>(numSamples)));
+        level.push_back(merged);
+      }
+    }
+
+    levels_.push_back(std::move(level));
+  }
+}
+
+inline std::int64_t WaveformOverview::getSamplesPerBucket(
+    int level) const noexcept {
+  auto samplesPerBucket = static_cast<std::int64_t>(args_.samplesPerBucket);
+  for (auto i = 0; i < level; ++i) {
+    samplesPerBucket *= args_.decimationFactor;
+  }
+  return samplesPerBucket;
+}
+
+inline std::int64_t WaveformOverview::getNumBuckets(int level) const noexcept {
+  const auto samplesPerBucket = getSamplesPerBucket(level);
+  return (lengthInSamples_ + samplesPerBucket - 1) / samplesPerBucket;
+}
+
+inline std::int64_t WaveformOverview::getNumSamplesIn(
+    int level,
+    std::int64_t bucket) const {
+  const auto samplesPerBucket = getSamplesPerBucket(level);
+  // only the last bucket may be shorter
+  return std::min(samplesPerBucket,
+                  lengthInSamples_ - bucket * samplesPerBucket);
+}
+
+inline std::span<const OverviewBucket> WaveformOverview::getLevel(
+    int level,
+    int channel) const {
+  WS_PRECONDITION(0 <= level && level < getNumLevels());
+  WS_PRECONDITION(0 <= channel && channel < numChannels_);
+  const auto numBuckets = static_cast<std::size_t>(getNumBuckets(level));
+  return std::span{levels_[static_cast<std::size_t>(level)]}.subspan(
+      static_cast<std::size_t>(channel) * numBuckets, numBuckets);
+}
+
+inline void WaveformOverview::getPixels(
+    int channel,
+    std::int64_t startSample,
+    std::int64_t numSamples,
+    std::span<OverviewBucket> pixels) const {
+  WS_PRECONDITION(startSample >= 0 && numSamples >= 0);
+  if (pixels.empty()) {
+    return;
+  }
+
+  const auto samplesPerPixel =
+      static_cast<double>(numSamples) / static_cast<double>(pixels.size());
+
+  // the coarsest level whose buckets are not wider than a pixel
+  auto level = 0;
+  while (level + 1 < getNumLevels() &&
+         static_cast<double>(getSamplesPerBucket(level + 1)) <=
+             samplesPerPixel) {
+    ++level;
+  }
+  const auto samplesPerBucket = getSamplesPerBucket(level);
+  const auto buckets = getLevel(level, channel);
+  const auto numBuckets = static_cast<std::int64_t>(buckets.size());
+
+  for (auto pixel = 0u; pixel < pixels.size(); ++pixel) {
+    const auto start =
+        startSample + static_cast<std::int64_t>(pixel * samplesPerPixel);
+    const auto end = std::max(
+        start + 1, startSample + static_cast<std::int64_t>(
+                                     (pixel + 1) * samplesPerPixel));
+    const auto firstBucket = start / samplesPerBucket;
+    const auto lastBucket =
+        std::min(numBuckets, (end + samplesPerBucket - 1) / samplesPerBucket);
+
+    if (start >= lengthInSamples_ || firstBucket >= lastBucket) {
+      pixels[pixel] = {};
+      continue;
+    }
+
+    OverviewBucket merged{.min = std::numeric_limits<float>::max(),
+                          .max = std::numeric_limits<float>::lowest()};
+    auto sumOfSquares = 0.0;
+    auto count = std::int64_t{0};
+    for (auto bucket = firstBucket; bucket < lastBucket; ++bucket) {
+      const auto& summary = buckets[static_cast<std::size_t>(bucket)];
+      const auto numSamplesInBucket = getNumSamplesIn(level, bucket);
+      merged.min = std::min(merged.min, summary.min);
+      merged.max = std::max(merged.max, summary.max);
+      sumOfSquares += static_cast<double>(summary.rms) * summary.rms *
+                      static_cast<double>(numSamplesInBucket);
+      count += numSamplesInBucket;
+    }
+    merged.rms = static_cast<float>(std::sqrt(sumOfSquares / count));
+    pixels[pixel] = merged;
+  }
+}
+
+inline WaveformOverview WaveformOverview::build(
+    juce::AudioFormatReader& reader,
+    Args args) {
+  constexpr auto BLOCK_SIZE = 1 << 16;
+
+  const auto numChannels = static_cast<int>(reader.numChannels);
+  Builder builder{numChannels, reader.sampleRate, args};
+  juce::AudioBuffer<float> block{numChannels, BLOCK_SIZE};
+
+  for (juce::int64 start = 0; start < reader.lengthInSamples;
+       start += BLOCK_SIZE) {
+    const auto blockLength = static_cast<int>(
+        std::min<juce::int64>(BLOCK_SIZE, reader.lengthInSamples - start));
+    if (!reader.read(block.getArrayOfWritePointers(), numChannels, start,
+                     blockLength)) {
+      throw std::runtime_error{"Could not read audio samples"};
+    }
+    builder.addBlock(block.getArrayOfReadPointers(), blockLength);
+  }
+
+  return std::move(builder).finish();
+}
+
+inline WaveformOverview WaveformOverview::build(const juce::File& audioFile,
+                                                Args args) {
+  return build(*createAudioFormatReader(audioFile), args);
+}
+
+inline std::optional<WaveformOverview> WaveformOverview::load(
+    const juce::File& overviewFile,
+    const juce::File& sourceFile) {
+  if (!overviewFile.existsAsFile() || !sourceFile.existsAsFile()) {
+    return std::nullopt;
+  }
+
+  juce::FileInputStream input{overviewFile};
+  Header header{};
+  if (input.failedToOpen() ||
+      input.read(&header, sizeof(Header)) != sizeof(Header) ||
+      header.magic != MAGIC || header.version != VERSION ||
+      header.numChannels == 0u || header.samplesPerBucket == 0u ||
+      header.decimationFactor < 2u || header.numLevels == 0u ||
+      header.numLevels > MAX_NUM_LEVELS || header.lengthInSamples < 0 ||
+      header.sourceFileSize != sourceFile.getSize()) {
+    return std::nullopt;
+  }
+
+  // as in SampleCacheFile, a new timestamp alone does not invalidate
+  const auto modificationTime =
+      sourceFile.getLastModificationTime().toMilliseconds();
+  const auto timestampChanged =
+      header.sourceModificationTime != modificationTime;
+  if (timestampChanged &&
+      header.sourceContentHash != SampleCacheFile::contentHashOf(sourceFile)) {
+    return std::nullopt;
+  }
+
+  WaveformOverview overview;
+  overview.numChannels_ = static_cast<int>(header.numChannels);
+  overview.sampleRate_ = header.sampleRate;
+  overview.lengthInSamples_ = header.lengthInSamples;
+  overview.args_ = {
+      .samplesPerBucket = static_cast<int>(header.samplesPerBucket),
+      .decimationFactor = static_cast<int>(header.decimationFactor)};
+
+  for (auto level = 0; level < static_cast<int>(header.numLevels); ++level) {
+    const auto numBuckets =
+        static_cast<std::size_t>(overview.getNumBuckets(level)) *
+        header.numChannels;
+    auto& buckets = overview.levels_.emplace_back(numBuckets);
+    const auto sizeInBytes = numBuckets * sizeof(OverviewBucket);
+    if (input.read(buckets.data(), static_cast<int>(sizeInBytes)) !=
+        static_cast<int>(sizeInBytes)) {
+      return std::nullopt;
+    }
+  }
+
+  if (!input.isExhausted()) {
+    return std::nullopt;
+  }
+
+  if (timestampChanged) {
+    // Same contents, new timestamp: remember it to skip hashing next time.
+    // This is an optimization only, so failures are ignored.
+    header.sourceModificationTime = modificationTime;
+    juce::FileOutputStream output{overviewFile};
+    if (output.openedOk() && output.setPosition(0)) {
+      output.write(&header, sizeof(Header));
+    }
+  }
+  return overview;
+}
+
+inline void WaveformOverview::save(const juce::File& overviewFile,
+                                   const juce::File& sourceFile) const {
+  const Header header{
+      .magic = MAGIC,
+      .version = VERSION,
+      .numChannels = static_cast<std::uint32_t>(numChannels_),
+      .numLevels = static_cast<std::uint32_t>(getNumLevels()),
+      .samplesPerBucket = static_cast<std::uint32_t>(args_.samplesPerBucket),
+      .decimationFactor = static_cast<std::uint32_t>(args_.decimationFactor),
+      .lengthInSamples = lengthInSamples_,
+      .sampleRate = sampleRate_,
+      .sourceFileSize = sourceFile.getSize(),
+      .sourceModificationTime =
+          sourceFile.getLastModificationTime().toMilliseconds(),
+      .sourceContentHash = SampleCacheFile::contentHashOf(sourceFile)};
+
+  const auto directoryCreationResult =
+      overviewFile.getParentDirectory().createDirectory();
+  if (directoryCreationResult.failed()) {
+    throw std::runtime_error{
+        directoryCreationResult.getErrorMessage().toStdString()};
+  }
+
+  const juce::TemporaryFile temporaryFile{overviewFile};
+  {
+    juce::FileOutputStream output{temporaryFile.getFile()};
+    if (output.failedToOpen()) {
+      throw std::runtime_error{"failed to open the overview file"};
+    }
+
+    auto succeeded = output.write(&header, sizeof(Header));
+    for (const auto& level : levels_) {
+      succeeded =
+          succeeded &&
+          output.write(level.data(), level.size() * sizeof(OverviewBucket));
+    }
+    output.flush();
+
+    if (!succeeded) {
+      throw std::runtime_error{"failed to write the overview file"};
+    }
+  }
+
+  if (!temporaryFile.overwriteTargetFileWithTemporary()) {
+    throw std::runtime_error{"failed to move the overview file in place"};
+  }
+}
+
+inline WaveformOverview WaveformOverview::loadOrBuild(
+    const juce::File& audioFile) {
+  return loadOrBuild(audioFile, Args{});
+}
+
+inline WaveformOverview WaveformOverview::loadOrBuild(
+    const juce::File& audioFile,
+    Args args) {
+  const auto overviewFile =
+      audioFile.getSiblingFile(audioFile.getFileName() + FILE_EXTENSION);
+  if (auto overview = load(overviewFile, audioFile);
+      overview && overview->args_.samplesPerBucket == args.samplesPerBucket &&
+      overview->args_.decimationFactor == args.decimationFactor) {
+    return std::move(*overview);
+  }
+
+  auto overview = build(audioFile, args);
+  try {
+    overview.save(overviewFile, audioFile);
+  } catch (const std::runtime_error& e) {
+    // the sidecar is an optimization; failing to write it is not an error
+    DBG("Could not write overview file: " + juce::String{e.what()});
+  }
+  return overview;
+}
+}  // namespace wolfsound
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <juce_audio_formats/juce_audio_formats.h>
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+
+namespace wolfsound {
+namespace detail {
+/** @brief Presents a BW64 stream as RF64, which JUCE can read.
+ *
+ * BW64 (ITU-R BS.2088) only differs from RF64 (EBU Tech 3306) in the ID of
+ * the first chunk, so that ID is all that is replaced.
+ */
+class Bw64AsRf64InputStream : public juce::InputStream {
+public:
+  explicit Bw64AsRf64InputStream(std::unique_ptr<juce::InputStream> source)
+      : source_{std::move(source)} {}
+
+  juce::int64 getTotalLength() override { return source_->getTotalLength(); }
+  bool isExhausted() override { return source_->isExhausted(); }
+  juce::int64 getPosition() override { return source_->getPosition(); }
+  bool setPosition(juce::int64 newPosition) override {
+    return source_->setPosition(newPosition);
+  }
+
+  int read(void* destination, int maxBytesToRead) override {
+    static constexpr char RF64_ID[] = "RF64";
+    constexpr juce::int64 ID_SIZE = 4;
+
+    const auto position = source_->getPosition();
+    const auto bytesRead = source_->read(destination, maxBytesToRead);
+    if (position < ID_SIZE && bytesRead > 0) {
+      const auto count = std::min<juce::int64>(ID_SIZE - position, bytesRead);
+      std::memcpy(destination, RF64_ID + position,
+                  static_cast<std::size_t>(count));
+    }
+    return bytesRead;
+  }
+
+private:
+  std::unique_ptr<juce::InputStream> source_;
+};
+
+[[nodiscard]] inline bool startsWithBw64(const juce::File& file) {
+  juce::FileInputStream stream{file};
+  char id[4]{};
+  return stream.openedOk() && stream.read(id, 4) == 4 &&
+         std::memcmp(id, "BW64", 4u) == 0;
+}
+}  // namespace detail
+
+/** @brief Opens @p file with the reader of its format, out of those of
+ * juce::AudioFormatManager::registerBasicFormats().
+ *
+ * WAV files over 4 GB are read from their RF64 or BW64 containers.
+ *
+ * @throws std::runtime_error if the file cannot be opened or has an
+ * unsupported format
+ */
+[[nodiscard]] inline std::unique_ptr<juce::AudioFormatReader>
+createAudioFormatReader(const juce::File& file) {
+  juce::AudioFormatManager formatManager;
+  formatManager.registerBasicFormats();
+
+  std::unique_ptr<juce::AudioFormatReader> reader;
+  if (detail::startsWithBw64(file)) {
+    reader.reset(formatManager.createReaderFor(
+        std::make_unique<detail::Bw64AsRf64InputStream>(
+            file.createInputStream())));
+  } else {
+    reader.reset(formatManager.createReaderFor(file));
+  }
+
+  if (reader == nullptr) {
+    throw std::runtime_error{"Could not open file: " +
+                             file.getFullPathName().toStdString()};
+  }
+  return reader;
+}
+}  // namespace wolfsound
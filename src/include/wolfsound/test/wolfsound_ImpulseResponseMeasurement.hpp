@@ -0,0 +1,53 @@
+#pragma once
+
+#include <wolfsound/common/wolfsound_DecibelsFullScale.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <optional>
+#include <span>
+
+namespace wolfsound {
+/** @brief Latency and tail length of a processor, read off its response to
+ * a unit impulse at sample 0.
+ */
+struct ImpulseResponseMeasurement {
+  /** @brief Position of the largest absolute sample of the response. */
+  std::int64_t latencyInSamples = 0;
+
+  /** @brief Samples from the peak to the last sample whose level is at
+   * least the threshold; 0 if the response ends at its peak. */
+  std::int64_t tailLengthInSamples = 0;
+
+  float peak = 0.f;
+
+  /** @brief Measures @p response against @p threshold.
+   *
+   * @return std::nullopt if no sample reaches @p threshold
+   */
+  [[nodiscard]] static std::optional<ImpulseResponseMeasurement> from(
+      std::span<const float> response,
+      DecibelsFullScale threshold);
+};
+
+inline std::optional<ImpulseResponseMeasurement>
+ImpulseResponseMeasurement::from(std::span<const float> response,
+                                 DecibelsFullScale threshold) {
+  const auto magnitude = [](float sample) { return std::abs(sample); };
+  const auto peak = std::ranges::max_element(response, {}, magnitude);
+  const auto thresholdLevel = std::pow(10.f, threshold.value() / 20.f);
+  if (peak == response.end() || std::abs(*peak) < thresholdLevel) {
+    return std::nullopt;
+  }
+
+  const auto lastAudible = std::ranges::find_if(
+      response.rbegin(), response.rend(),
+      [&](float sample) { return std::abs(sample) >= thresholdLevel; });
+  const auto latencyInSamples = peak - response.begin();
+  return ImpulseResponseMeasurement{
+      .latencyInSamples = latencyInSamples,
+      .tailLengthInSamples =
+          (response.rend() - lastAudible - 1) - latencyInSamples,
+      .peak = *peak};
+}
+}  // namespace wolfsound
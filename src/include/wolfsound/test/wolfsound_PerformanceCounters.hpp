@@ -0,0 +1,252 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace wolfsound {
+/** @brief Hardware events counted while the code of interest ran.
+ *
+ * A count is empty if the system does not provide that counter, e.g., in a
+ * container or a virtual machine without a virtual PMU.
+ */
+struct PerformanceCounterValues {
+  std::optional<std::uint64_t> cycles;
+  std::optional<std::uint64_t> instructions;
+  std::optional<std::uint64_t> l1DataCacheMisses;
+  /** @brief Misses of the cache the CPU counts them for, usually the
+   * last-level cache. */
+  std::optional<std::uint64_t> lastLevelCacheMisses;
+  std::optional<std::uint64_t> branchMisses;
+
+  [[nodiscard]] std::optional<double> instructionsPerCycle() const;
+
+  /** @brief Only the available counts. */
+  [[nodiscard]] juce::var toVar() const;
+};
+
+/** @brief Counts hardware events of the calling thread with Linux
+ * perf_event_open().
+ *
+ * The counters are opened as a single group, so one read() takes a
+ * snapshot of all of them. The kernel schedules a group all or nothing: a
+ * counter that does not fit onto the CPU next to the ones before it fails
+ * to open and is left out, like any other counter the system refuses. If
+ * the group has to share the CPU with other groups, it counts only part of
+ * the time and the totals are scaled up by that fraction; if it never got
+ * to count, every total is empty. Only user-space events are counted, so
+ * that the default perf_event_paranoid level permits them; kernel time
+ * spent in the measured code is not included.
+ *
+ * If no counter can be opened, start() and stop() do nothing and every
+ * total is empty. The instance must be used on the thread that created it.
+ *
+ * @code
+ * PerformanceCounters counters;
+ * for (auto& block : blocks) {
+ *   counters.start();
+ *   processor.process(block);
+ *   counters.stop();
+ * }
+ * const auto totals = counters.getTotals();
+ * @endcode
+ */
+class PerformanceCounters {
+public:
+  PerformanceCounters();
+  ~PerformanceCounters();
+
+  PerformanceCounters(const PerformanceCounters&) = delete;
+  PerformanceCounters& operator=(const PerformanceCounters&) = delete;
+
+  /** @brief True if at least one counter could be opened. */
+  [[nodiscard]] bool isAvailable() const noexcept { return numOpen_ > 0; }
+
+  /** @brief Starts an interval to count; a single read() system call. */
+  void start() noexcept;
+
+  /** @brief Adds the events since start() to the totals; a single read()
+   * system call. The interval is left out if either read fails. */
+  void stop() noexcept;
+
+  /** @brief Sums of all start()-stop() intervals. */
+  [[nodiscard]] PerformanceCounterValues getTotals() const;
+
+private:
+  static constexpr std::size_t NUM_COUNTERS = 5u;
+
+  // the layout of a group read with PERF_FORMAT_TOTAL_TIME_ENABLED and
+  // PERF_FORMAT_TOTAL_TIME_RUNNING: number of counters, time enabled, time
+  // running, and the counts in the order of opening
+  static constexpr std::size_t HEADER_SIZE = 3u;
+  using Snapshot = std::array<std::uint64_t, HEADER_SIZE + NUM_COUNTERS>;
+
+  bool read(Snapshot& snapshot) const noexcept;
+
+  std::array<int, NUM_COUNTERS> fileDescriptors_{};
+  /** @brief The first counter opened; reads the whole group. */
+  int leader_ = -1;
+  std::size_t numOpen_ = 0u;
+  Snapshot started_{};
+  /** @brief False if start() could not read the counters. */
+  bool isStarted_ = false;
+  Snapshot totals_{};
+};
+
+inline std::optional<double> PerformanceCounterValues::instructionsPerCycle()
+    const {
+  if (!cycles.has_value() || !instructions.has_value() || *cycles == 0u) {
+    return std::nullopt;
+  }
+  return static_cast<double>(*instructions) / static_cast<double>(*cycles);
+}
+
+inline juce::var PerformanceCounterValues::toVar() const {
+  const juce::DynamicObject::Ptr object{new juce::DynamicObject};
+  const auto setIfAvailable = [&](const char* name,
+                                  std::optional<std::uint64_t> value) {
+    if (value.has_value()) {
+      object->setProperty(name, static_cast<juce::int64>(*value));
+    }
+  };
+  setIfAvailable("cycles", cycles);
+  setIfAvailable("instructions", instructions);
+  setIfAvailable("l1DataCacheMisses", l1DataCacheMisses);
+  setIfAvailable("lastLevelCacheMisses", lastLevelCacheMisses);
+  setIfAvailable("branchMisses", branchMisses);
+  if (const auto ipc = instructionsPerCycle()) {
+    object->setProperty("instructionsPerCycle", *ipc);
+  }
+  return juce::var{object};
+}
+
+namespace detail {
+/** @brief Where each counter of PerformanceCounters goes, in the order they
+ * are opened. */
+using PerformanceCounterField =
+    std::optional<std::uint64_t> PerformanceCounterValues::*;
+
+inline constexpr std::array<PerformanceCounterField, 5u>
+    PERFORMANCE_COUNTER_FIELDS{&PerformanceCounterValues::cycles,
+                               &PerformanceCounterValues::instructions,
+                               &PerformanceCounterValues::l1DataCacheMisses,
+                               &PerformanceCounterValues::lastLevelCacheMisses,
+                               &PerformanceCounterValues::branchMisses};
+}  // namespace detail
+
+inline PerformanceCounters::PerformanceCounters() {
+  fileDescriptors_.fill(-1);
+
+#if defined(__linux__)
+  constexpr std::array<std::pair<std::uint32_t, std::uint64_t>, NUM_COUNTERS>
+      events{{{PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+              {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+              {PERF_TYPE_HW_CACHE,
+               PERF_COUNT_HW_CACHE_L1D |
+                   (PERF_COUNT_HW_CACHE_OP_READ << 8u) |
+                   (PERF_COUNT_HW_CACHE_RESULT_MISS << 16u)},
+              {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+              {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES}}};
+
+  for (auto i = 0u; i < NUM_COUNTERS; ++i) {
+    perf_event_attr attributes{};
+    attributes.size = sizeof(attributes);
+    attributes.type = events[i].first;
+    attributes.config = events[i].second;
+    attributes.read_format =
+        PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED |
+        PERF_FORMAT_TOTAL_TIME_RUNNING;
+    attributes.exclude_kernel = 1;
+    attributes.exclude_hv = 1;
+
+    // this thread, any CPU
+    const auto fileDescriptor = static_cast<int>(
+        syscall(SYS_perf_event_open, &attributes, 0, -1, leader_, 0ul));
+    if (fileDescriptor < 0) {
+      continue;
+    }
+    fileDescriptors_[i] = fileDescriptor;
+    ++numOpen_;
+    if (leader_ < 0) {
+      leader_ = fileDescriptor;
+    }
+  }
+#endif
+}
+
+inline PerformanceCounters::~PerformanceCounters() {
+#if defined(__linux__)
+  // the leader last
+  for (auto i = NUM_COUNTERS; i-- > 0u;) {
+    if (fileDescriptors_[i] >= 0) {
+      close(fileDescriptors_[i]);
+    }
+  }
+#endif
+}
+
+inline void PerformanceCounters::start() noexcept {
+  isStarted_ = read(started_);
+}
+
+inline void PerformanceCounters::stop() noexcept {
+  // the counts since the counters were opened would be added otherwise
+  if (!isStarted_) {
+    return;
+  }
+  isStarted_ = false;
+  Snapshot stopped{};
+  if (!read(stopped)) {
+    return;
+  }
+  // the first entry is the number of counters, not a count
+  for (auto i = 1u; i < HEADER_SIZE + numOpen_; ++i) {
+    totals_[i] += stopped[i] - started_[i];
+  }
+}
+
+inline PerformanceCounterValues PerformanceCounters::getTotals() const {
+  PerformanceCounterValues values;
+  const auto timeEnabled = totals_[1];
+  const auto timeRunning = totals_[2];
+  // the group never got onto the PMU; the counts are unknown
+  if (timeRunning == 0u && timeEnabled > 0u) {
+    return values;
+  }
+
+  const auto scale = timeRunning > 0u ? static_cast<double>(timeEnabled) /
+                                            static_cast<double>(timeRunning)
+                                      : 1.0;
+  auto index = HEADER_SIZE;
+  for (auto i = 0u; i < NUM_COUNTERS; ++i) {
+    if (fileDescriptors_[i] >= 0) {
+      const auto field = detail::PERFORMANCE_COUNTER_FIELDS[i];
+      values.*field = static_cast<std::uint64_t>(
+          static_cast<double>(totals_[index++]) * scale);
+    }
+  }
+  return values;
+}
+
+inline bool PerformanceCounters::read(Snapshot& snapshot) const noexcept {
+#if defined(__linux__)
+  if (numOpen_ == 0u) {
+    return false;
+  }
+  const auto size = (HEADER_SIZE + numOpen_) * sizeof(std::uint64_t);
+  return ::read(leader_, snapshot.data(), size) ==
+         static_cast<ssize_t>(size);
+#else
+  static_cast<void>(snapshot);
+  return false;
+#endif
+}
+}  // namespace wolfsound
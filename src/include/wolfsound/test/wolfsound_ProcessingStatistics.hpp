@@ -0,0 +1,190 @@
+#pragma once
+
+#include <wolfsound/common/wolfsound_assert.hpp>
+#include <juce_core/juce_core.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <time.h>
+#define WS_HAS_THREAD_CPU_TIME 1
+#else
+#define WS_HAS_THREAD_CPU_TIME 0
+#endif
+
+namespace wolfsound {
+namespace detail {
+/** @brief CPU time consumed by the calling thread so far; always 0 on
+ * platforms without CLOCK_THREAD_CPUTIME_ID. */
+[[nodiscard]] inline std::chrono::nanoseconds threadCpuTime() noexcept {
+#if WS_HAS_THREAD_CPU_TIME
+  timespec time{};
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time);
+  return std::chrono::seconds{time.tv_sec} +
+         std::chrono::nanoseconds{time.tv_nsec};
+#else
+  return std::chrono::nanoseconds{0};
+#endif
+}
+}  // namespace detail
+
+/** @brief Cost of one process() call. */
+struct BlockTiming {
+  std::int64_t startSample = 0;
+  int numSamples = 0;
+  /** @brief Measured with std::chrono::steady_clock. */
+  std::chrono::nanoseconds wallTime{0};
+  /** @brief CPU time of the processing thread; includes no time spent
+   * waiting, e.g., on locks. */
+  std::chrono::nanoseconds cpuTime{0};
+};
+
+/** @brief Calls @p process and measures how long it took. */
+template <typename Function>
+[[nodiscard]] BlockTiming measureBlock(std::int64_t startSample,
+                                       int numSamples,
+                                       Function&& process) {
+  const auto cpuStart = detail::threadCpuTime();
+  const auto wallStart = std::chrono::steady_clock::now();
+  process();
+  const auto wallEnd = std::chrono::steady_clock::now();
+  const auto cpuEnd = detail::threadCpuTime();
+  return {.startSample = startSample,
+          .numSamples = numSamples,
+          .wallTime = wallEnd - wallStart,
+          .cpuTime = cpuEnd - cpuStart};
+}
+
+struct LatencyPercentiles {
+  std::chrono::nanoseconds p50{0};
+  std::chrono::nanoseconds p99{0};
+  std::chrono::nanoseconds p999{0};
+  std::chrono::nanoseconds max{0};
+
+  /** @brief Nearest-rank percentiles of @p latencies. */
+  [[nodiscard]] static LatencyPercentiles from(
+      std::vector<std::chrono::nanoseconds> latencies);
+
+  [[nodiscard]] juce::var toVar() const;
+};
+
+/** @brief Summary of the cost of processing a file block by block.
+ *
+ * The real-time factor is the processing time divided by the duration of
+ * the processed audio: below 1, processing is faster than real time. A
+ * block is over budget if processing it took longer than playing it back.
+ */
+struct ProcessingStatistics {
+  double sampleRate = 0.0;
+  std::int64_t numBlocks = 0;
+  std::int64_t numSamples = 0;
+
+  std::chrono::nanoseconds totalWallTime{0};
+  std::chrono::nanoseconds totalCpuTime{0};
+  double realTimeFactor = 0.0;
+  double cpuRealTimeFactor = 0.0;
+
+  LatencyPercentiles wallTime{};
+  LatencyPercentiles cpuTime{};
+
+  std::int64_t numBlocksOverBudget = 0;
+
+  [[nodiscard]] static ProcessingStatistics from(
+      std::span<const BlockTiming> blocks,
+      double sampleRate);
+
+  /** @brief A juce::DynamicObject to be written with juce::JSON; durations
+   * are in nanoseconds. */
+  [[nodiscard]] juce::var toVar() const;
+};
+
+inline LatencyPercentiles LatencyPercentiles::from(
+    std::vector<std::chrono::nanoseconds> latencies) {
+  if (latencies.empty()) {
+    return {};
+  }
+
+  std::ranges::sort(latencies);
+  auto percentile = [&](double fraction) {
+    const auto rank = static_cast<std::size_t>(
+        std::ceil(fraction * static_cast<double>(latencies.size())));
+    return latencies[std::max<std::size_t>(rank, 1u) - 1u];
+  };
+  return {.p50 = percentile(0.5),
+          .p99 = percentile(0.99),
+          .p999 = percentile(0.999),
+          .max = latencies.back()};
+}
+
+inline juce::var LatencyPercentiles::toVar() const {
+  const juce::DynamicObject::Ptr object{new juce::DynamicObject};
+  object->setProperty("p50", static_cast<juce::int64>(p50.count()));
+  object->setProperty("p99", static_cast<juce::int64>(p99.count()));
+  object->setProperty("p99.9", static_cast<juce::int64>(p999.count()));
+  object->setProperty("max", static_cast<juce::int64>(max.count()));
+  return juce::var{object};
+}
+
+inline ProcessingStatistics ProcessingStatistics::from(
+    std::span<const BlockTiming> blocks,
+    double sampleRate) {
+  WS_PRECONDITION(sampleRate > 0.0);
+
+  ProcessingStatistics statistics{
+      .sampleRate = sampleRate,
+      .numBlocks = static_cast<std::int64_t>(blocks.size())};
+  std::vector<std::chrono::nanoseconds> wallTimes;
+  std::vector<std::chrono::nanoseconds> cpuTimes;
+  wallTimes.reserve(blocks.size());
+  cpuTimes.reserve(blocks.size());
+
+  for (const auto& block : blocks) {
+    statistics.numSamples += block.numSamples;
+    statistics.totalWallTime += block.wallTime;
+    statistics.totalCpuTime += block.cpuTime;
+    wallTimes.push_back(block.wallTime);
+    cpuTimes.push_back(block.cpuTime);
+
+    const std::chrono::duration<double> budget{block.numSamples / sampleRate};
+    if (block.wallTime > budget) {
+      ++statistics.numBlocksOverBudget;
+    }
+  }
+
+  const auto audioDuration =
+      static_cast<double>(statistics.numSamples) / sampleRate;
+  if (audioDuration > 0.0) {
+    using Seconds = std::chrono::duration<double>;
+    statistics.realTimeFactor =
+        Seconds{statistics.totalWallTime}.count() / audioDuration;
+    statistics.cpuRealTimeFactor =
+        Seconds{statistics.totalCpuTime}.count() / audioDuration;
+  }
+  statistics.wallTime = LatencyPercentiles::from(std::move(wallTimes));
+  statistics.cpuTime = LatencyPercentiles::from(std::move(cpuTimes));
+
+  return statistics;
+}
+
+inline juce::var ProcessingStatistics::toVar() const {
+  const juce::DynamicObject::Ptr object{new juce::DynamicObject};
+  object->setProperty("sampleRate", sampleRate);
+  object->setProperty("numBlocks", static_cast<juce::int64>(numBlocks));
+  object->setProperty("numSamples", static_cast<juce::int64>(numSamples));
+  object->setProperty("totalWallTime",
+                      static_cast<juce::int64>(totalWallTime.count()));
+  object->setProperty("totalCpuTime",
+                      static_cast<juce::int64>(totalCpuTime.count()));
+  object->setProperty("realTimeFactor", realTimeFactor);
+  object->setProperty("cpuRealTimeFactor", cpuRealTimeFactor);
+  object->setProperty("wallTime", wallTime.toVar());
+  object->setProperty("cpuTime", cpuTime.toVar());
+  object->setProperty("numBlocksOverBudget",
+                      static_cast<juce::int64>(numBlocksOverBudget));
+  return juce::var{object};
+}
+}  // namespace wolfsound
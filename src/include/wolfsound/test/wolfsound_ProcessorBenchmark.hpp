@@ -0,0 +1,488 @@
+#pragma once
+
+#include <wolfsound/common/wolfsound_Frequency.hpp>
+#include <wolfsound/common/wolfsound_assert.hpp>
+#include <wolfsound/dsp/wolfsound_testSignals.hpp>
+#include <wolfsound/test/wolfsound_PerformanceCounters.hpp>
+#include <wolfsound/test/wolfsound_ProcessingStatistics.hpp>
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <algorithm>
+#include <barrier>
+#include <chrono>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace wolfsound {
+struct ProcessorBenchmarkResult {
+  double sampleRate = 0.0;
+  int blockSize = 0;
+  int numInputChannels = 0;
+  int numOutputChannels = 0;
+
+  /** @brief False if the processor rejected the channel layout; nothing is
+   * measured then. */
+  bool supported = false;
+
+  ProcessingStatistics statistics{};
+
+  /** @brief Counted CPU cycles per sample frame if performanceCounters has
+   * them, otherwise CPU time per sample frame times the nominal CPU clock;
+   * 0 if neither is known. */
+  double cyclesPerSample = 0.0;
+
+  /** @brief Sample frames processed per second of wall time. */
+  double samplesPerSecond = 0.0;
+
+  /** @brief Events counted over the measured processBlock() calls; empty
+   * unless Args::readPerformanceCounters is set. */
+  std::optional<PerformanceCounterValues> performanceCounters{};
+
+  [[nodiscard]] juce::var toVar() const;
+};
+
+struct ProcessorScalingResult {
+  int numInstances = 0;
+
+  /** @brief Sample frames processed per second of wall time by all
+   * instances together. */
+  double aggregateSamplesPerSecond = 0.0;
+
+  /** @brief One entry per instance; compare their wallTime percentiles to
+   * see how the tail latency grows with numInstances. */
+  std::vector<ProcessingStatistics> instances{};
+
+  /** @brief True if every instance thread was pinned to a CPU; false if
+   * pinning was not asked for or the system refused it. */
+  bool threadsPinned = false;
+
+  [[nodiscard]] juce::var toVar() const;
+};
+
+namespace detail {
+/** @brief The CPUs the calling thread may run on, e.g., as restricted by
+ * taskset or a container; empty where unknown. */
+[[nodiscard]] inline std::vector<int> getAllowedCpus() {
+  std::vector<int> allowed;
+#if defined(__linux__)
+  cpu_set_t cpus;
+  CPU_ZERO(&cpus);
+  if (sched_getaffinity(0, sizeof(cpus), &cpus) == 0) {
+    for (auto cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+      if (CPU_ISSET(cpu, &cpus)) {
+        allowed.push_back(cpu);
+      }
+    }
+  }
+#endif
+  return allowed;
+}
+
+/** @brief Restricts the calling thread to @p cpu, where supported.
+ *
+ * @return true if the thread has been pinned
+ */
+inline bool pinCurrentThreadToCpu(int cpu) noexcept {
+#if defined(__linux__)
+  cpu_set_t cpus;
+  CPU_ZERO(&cpus);
+  CPU_SET(cpu, &cpus);
+  return pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus) == 0;
+#else
+  return false;
+#endif
+}
+}  // namespace detail
+
+/** @brief Measures the cost of any juce::AudioProcessor over a matrix of
+ * sample rates, block sizes, and channel layouts.
+ *
+ * For every configuration, the processor is prepared as a host would do and
+ * then fed a pre-generated test signal block by block; only the
+ * processBlock() calls are timed. The first blocks warm up caches and
+ * branch predictors and are not measured.
+ *
+ * runScaling() instead runs several instances at once, one per thread,
+ * to reveal what only shows under concurrency: contention for caches and
+ * memory bandwidth, false sharing, and shared static state.
+ *
+ * @code
+ * MyPluginProcessor processor;
+ * for (const auto& result : ProcessorBenchmark{}.run(processor)) {
+ *   std::cout << juce::JSON::toString(result.toVar()) << '\n';
+ * }
+ * @endcode
+ */
+class ProcessorBenchmark {
+public:
+  struct ChannelLayout {
+    int numInputChannels = 2;
+    int numOutputChannels = 2;
+  };
+
+  using SignalGenerator =
+      std::function<std::vector<float>(Frequency sampleRate, Seconds)>;
+
+  struct Args {
+    std::vector<double> sampleRates{44100.0, 48000.0, 96000.0};
+    std::vector<int> blockSizes{32, 64, 128, 256, 512, 1024};
+    std::vector<ChannelLayout> channelLayouts{{}};
+
+    /** @brief Audio processed per configuration, warm-up excluded. */
+    Seconds duration{10.f};
+
+    int numWarmUpBlocks = 16;
+
+    /** @brief If true, run() reads hardware performance counters around
+     * every measured processBlock() call. */
+    bool readPerformanceCounters = false;
+
+    /** @brief Fed to every input channel; generated once per sample rate.
+     */
+    SignalGenerator generateSignal = [](Frequency sampleRate,
+                                        Seconds duration) {
+      return generateWhiteNoise(sampleRate, duration, 1u);
+    };
+  };
+
+  struct ScalingConfiguration {
+    std::vector<int> numInstances{1, 2, 4, 8};
+    double sampleRate = 48000.0;
+    int blockSize = 256;
+    ChannelLayout channelLayout{};
+
+    /** @brief If true, instance i runs on the i-th of the CPUs the process
+     * may run on, modulo their count, which keeps the scheduler from
+     * migrating threads mid-measurement. */
+    bool pinThreads = true;
+  };
+
+  using ProcessorFactory =
+      std::function<std::unique_ptr<juce::AudioProcessor>()>;
+
+  ProcessorBenchmark() : ProcessorBenchmark{Args{}} {}
+
+  explicit ProcessorBenchmark(Args args) : args_{std::move(args)} {}
+
+  /** @brief Benchmarks @p processor in every configuration.
+   *
+   * @return one result per configuration, sample rates varying slowest and
+   * channel layouts fastest
+   */
+  [[nodiscard]] std::vector<ProcessorBenchmarkResult> run(
+      juce::AudioProcessor& processor) const;
+
+  /** @brief For every instance count, creates that many processors with
+   * @p createProcessor and runs them in parallel, each on its own thread.
+   *
+   * All instances are prepared and warmed up before any of them is
+   * measured, and they start measuring together.
+   *
+   * @throws std::runtime_error if the processor rejects the channel layout
+   * @throws the first exception thrown by processBlock() on any instance,
+   * once all instances have stopped
+   */
+  [[nodiscard]] std::vector<ProcessorScalingResult> runScaling(
+      const ProcessorFactory& createProcessor,
+      const ScalingConfiguration& configuration) const;
+
+private:
+  /** @brief Sets the play configuration and prepares @p processor.
+   *
+   * @return false if the processor does not support @p layout
+   */
+  [[nodiscard]] static bool prepare(juce::AudioProcessor& processor,
+                                    double sampleRate,
+                                    int blockSize,
+                                    ChannelLayout layout);
+
+  /** @brief Feeds @p signal through @p processor block by block.
+   *
+   * @param beforeMeasuring  called between the warm-up and the measured
+   * blocks
+   * @param counters  if not null, started and stopped around every measured
+   * block
+   */
+  template <typename Callback>
+  [[nodiscard]] std::vector<BlockTiming> processSignal(
+      juce::AudioProcessor& processor,
+      const std::vector<float>& signal,
+      int blockSize,
+      ChannelLayout layout,
+      Callback&& beforeMeasuring,
+      PerformanceCounters* counters = nullptr) const;
+
+  [[nodiscard]] ProcessorBenchmarkResult runOne(
+      juce::AudioProcessor& processor,
+      const std::vector<float>& signal,
+      double sampleRate,
+      int blockSize,
+      ChannelLayout layout) const;
+
+  Args args_;
+};
+
+inline juce::var ProcessorBenchmarkResult::toVar() const {
+  const juce::DynamicObject::Ptr object{new juce::DynamicObject};
+  object->setProperty("sampleRate", sampleRate);
+  object->setProperty("blockSize", blockSize);
+  object->setProperty("numInputChannels", numInputChannels);
+  object->setProperty("numOutputChannels", numOutputChannels);
+  object->setProperty("supported", supported);
+  object->setProperty("statistics", statistics.toVar());
+  object->setProperty("cyclesPerSample", cyclesPerSample);
+  object->setProperty("samplesPerSecond", samplesPerSecond);
+  if (performanceCounters.has_value()) {
+    object->setProperty("performanceCounters", performanceCounters->toVar());
+  }
+  return juce::var{object};
+}
+
+inline juce::var ProcessorScalingResult::toVar() const {
+  juce::Array<juce::var> instanceStatistics;
+  for (const auto& statistics : instances) {
+    instanceStatistics.add(statistics.toVar());
+  }
+
+  const juce::DynamicObject::Ptr object{new juce::DynamicObject};
+  object->setProperty("numInstances", numInstances);
+  object->setProperty("aggregateSamplesPerSecond", aggregateSamplesPerSecond);
+  object->setProperty("instances", instanceStatistics);
+  object->setProperty("threadsPinned", threadsPinned);
+  return juce::var{object};
+}
+
+inline std::vector<ProcessorBenchmarkResult> ProcessorBenchmark::run(
+    juce::AudioProcessor& processor) const {
+  std::vector<ProcessorBenchmarkResult> results;
+  for (const auto sampleRate : args_.sampleRates) {
+    const auto signal = args_.generateSignal(
+        Frequency{static_cast<float>(sampleRate)}, args_.duration);
+    for (const auto blockSize : args_.blockSizes) {
+      for (const auto& layout : args_.channelLayouts) {
+        results.push_back(
+            runOne(processor, signal, sampleRate, blockSize, layout));
+      }
+    }
+  }
+  return results;
+}
+
+inline ProcessorBenchmarkResult ProcessorBenchmark::runOne(
+    juce::AudioProcessor& processor,
+    const std::vector<float>& signal,
+    double sampleRate,
+    int blockSize,
+    ChannelLayout layout) const {
+  ProcessorBenchmarkResult result{
+      .sampleRate = sampleRate,
+      .blockSize = blockSize,
+      .numInputChannels = layout.numInputChannels,
+      .numOutputChannels = layout.numOutputChannels};
+
+  result.supported = prepare(processor, sampleRate, blockSize, layout);
+  if (!result.supported) {
+    return result;
+  }
+
+  std::optional<PerformanceCounters> counters;
+  if (args_.readPerformanceCounters) {
+    counters.emplace();
+  }
+  const auto timings =
+      processSignal(processor, signal, blockSize, layout, [] {},
+                    counters ? &*counters : nullptr);
+  processor.releaseResources();
+
+  result.statistics = ProcessingStatistics::from(timings, sampleRate);
+  using SecondsDouble = std::chrono::duration<double>;
+  const auto numSamples = static_cast<double>(result.statistics.numSamples);
+  if (counters) {
+    result.performanceCounters = counters->getTotals();
+  }
+  if (result.performanceCounters && result.performanceCounters->cycles) {
+    result.cyclesPerSample =
+        static_cast<double>(*result.performanceCounters->cycles) / numSamples;
+  } else {
+    const auto cyclesPerSecond =
+        juce::SystemStats::getCpuSpeedInMegahertz() * 1e6;
+    result.cyclesPerSample =
+        SecondsDouble{result.statistics.totalCpuTime}.count() *
+        cyclesPerSecond / numSamples;
+  }
+  const auto wallTime = SecondsDouble{result.statistics.totalWallTime}.count();
+  result.samplesPerSecond = wallTime > 0.0 ? numSamples / wallTime : 0.0;
+  return result;
+}
+
+inline std::vector<ProcessorScalingResult> ProcessorBenchmark::runScaling(
+    const ProcessorFactory& createProcessor,
+    const ScalingConfiguration& configuration) const {
+  const auto signal = args_.generateSignal(
+      Frequency{static_cast<float>(configuration.sampleRate)},
+      args_.duration);
+  // checked here as the instance threads could not report it
+  if (std::ssize(signal) < configuration.blockSize) {
+    throw std::runtime_error{"the benchmark signal is shorter than a block"};
+  }
+  const auto allowedCpus = detail::getAllowedCpus();
+
+  std::vector<ProcessorScalingResult> results;
+  for (const auto numInstances : configuration.numInstances) {
+    WS_PRECONDITION(numInstances > 0);
+
+    std::vector<std::unique_ptr<juce::AudioProcessor>> processors;
+    for (auto i = 0; i < numInstances; ++i) {
+      processors.push_back(createProcessor());
+      if (!prepare(*processors.back(), configuration.sampleRate,
+                   configuration.blockSize, configuration.channelLayout)) {
+        throw std::runtime_error{"the processor does not support the layout"};
+      }
+    }
+
+    const auto numThreads = static_cast<std::size_t>(numInstances);
+    std::vector<std::vector<BlockTiming>> timings(numThreads);
+    // not std::vector<bool>, whose elements the threads cannot set
+    // concurrently
+    std::vector<char> pinned(numThreads, false);
+    std::vector<std::exception_ptr> errors(numThreads);
+    // the instances and this thread, which keeps the time
+    std::barrier warmedUp{numInstances + 1};
+    std::chrono::steady_clock::time_point start;
+    {
+      std::vector<std::jthread> threads;
+      for (auto index = 0u; index < numThreads; ++index) {
+        threads.emplace_back([&, index] {
+          if (configuration.pinThreads && !allowedCpus.empty()) {
+            pinned[index] = detail::pinCurrentThreadToCpu(
+                allowedCpus[index % allowedCpus.size()]);
+          }
+          auto arrived = false;
+          try {
+            timings[index] = processSignal(
+                *processors[index], signal, configuration.blockSize,
+                configuration.channelLayout, [&] {
+                  arrived = true;
+                  warmedUp.arrive_and_wait();
+                });
+          } catch (...) {
+            errors[index] = std::current_exception();
+            // so that the others do not wait for this instance forever
+            if (!arrived) {
+              warmedUp.arrive_and_drop();
+            }
+          }
+        });
+      }
+      warmedUp.arrive_and_wait();
+      start = std::chrono::steady_clock::now();
+    }
+    const std::chrono::duration<double> wallTime =
+        std::chrono::steady_clock::now() - start;
+
+    for (const auto& processor : processors) {
+      processor->releaseResources();
+    }
+    for (const auto& error : errors) {
+      if (error) {
+        std::rethrow_exception(error);
+      }
+    }
+
+    ProcessorScalingResult result{
+        .numInstances = numInstances,
+        .threadsPinned = std::ranges::all_of(
+            pinned, [](char isPinned) { return isPinned != 0; })};
+    std::int64_t numSamples = 0;
+    for (const auto& instanceTimings : timings) {
+      result.instances.push_back(ProcessingStatistics::from(
+          instanceTimings, configuration.sampleRate));
+      numSamples += result.instances.back().numSamples;
+    }
+    result.aggregateSamplesPerSecond =
+        static_cast<double>(numSamples) / wallTime.count();
+    results.push_back(std::move(result));
+  }
+  return results;
+}
+
+inline bool ProcessorBenchmark::prepare(juce::AudioProcessor& processor,
+                                        double sampleRate,
+                                        int blockSize,
+                                        ChannelLayout layout) {
+  WS_PRECONDITION(sampleRate > 0.0);
+  WS_PRECONDITION(blockSize > 0);
+
+  processor.setPlayConfigDetails(layout.numInputChannels,
+                                 layout.numOutputChannels, sampleRate,
+                                 blockSize);
+  if (processor.getTotalNumInputChannels() != layout.numInputChannels ||
+      processor.getTotalNumOutputChannels() != layout.numOutputChannels) {
+    return false;
+  }
+
+  processor.setNonRealtime(false);
+  processor.prepareToPlay(sampleRate, blockSize);
+  return true;
+}
+
+template <typename Callback>
+std::vector<BlockTiming> ProcessorBenchmark::processSignal(
+    juce::AudioProcessor& processor,
+    const std::vector<float>& signal,
+    int blockSize,
+    ChannelLayout layout,
+    Callback&& beforeMeasuring,
+    PerformanceCounters* counters) const {
+  const auto numMeasuredBlocks = static_cast<int>(signal.size()) / blockSize;
+  if (numMeasuredBlocks == 0) {
+    throw std::runtime_error{"the benchmark signal is shorter than a block"};
+  }
+
+  juce::AudioBuffer<float> buffer{
+      std::max(layout.numInputChannels, layout.numOutputChannels), blockSize};
+  juce::MidiBuffer midiMessages;
+
+  std::vector<BlockTiming> timings;
+  timings.reserve(static_cast<std::size_t>(numMeasuredBlocks));
+  for (auto block = -args_.numWarmUpBlocks; block < numMeasuredBlocks;
+       ++block) {
+    if (block == 0) {
+      beforeMeasuring();
+    }
+
+    // warm-up blocks replay the start of the signal
+    const auto start = std::max(block, 0) * blockSize;
+    buffer.clear();
+    for (auto channel = 0; channel < layout.numInputChannels; ++channel) {
+      buffer.copyFrom(channel, 0, signal.data() + start, blockSize);
+    }
+    midiMessages.clear();
+
+    const auto measured = block >= 0;
+    if (measured && counters != nullptr) {
+      counters->start();
+    }
+    const auto timing = measureBlock(start, blockSize, [&] {
+      processor.processBlock(buffer, midiMessages);
+    });
+    if (measured) {
+      if (counters != nullptr) {
+        counters->stop();
+      }
+      timings.push_back(timing);
+    }
+  }
+  return timings;
+}
+}  // namespace wolfsound
@@ -2,33 +2,70 @@
 
 #include <juce_core/juce_core.h>
 #include <juce_dsp/juce_dsp.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
 #include <cstddef>
+#include <cstdint>
 #include <functional>
+#include <limits>
+#include <optional>
+#include <random>
+#include <stdexcept>
+#include <vector>
+#include <wolfsound/file/wolfsound_StreamingWavFileWriter.hpp>
 #include <wolfsound/file/wolfsound_WavFileReader.hpp>
-#include <wolfsound/file/wolfsound_WavFileWriter.hpp>
+#include <wolfsound/file/wolfsound_createAudioFormatReader.hpp>
+#include <wolfsound/common/wolfsound_DecibelsFullScale.hpp>
 #include <wolfsound/common/wolfsound_Frequency.hpp>
 #include <wolfsound/common/wolfsound_assert.hpp>
+#include <wolfsound/dsp/wolfsound_testSignals.hpp>
+#include <wolfsound/test/wolfsound_ImpulseResponseMeasurement.hpp>
+#include <wolfsound/test/wolfsound_PerformanceCounters.hpp>
+#include <wolfsound/test/wolfsound_ProcessingStatistics.hpp>
+#include <wolfsound/test/wolfsound_RealtimeSafetyCheck.hpp>
+#include <wolfsound/test/wolfsound_ReferenceComparison.hpp>
 
 namespace wolfsound {
-namespace detail {
-template <typename SampleType>
-std::vector<SampleType> vectorFromChannel(
-    const juce::dsp::AudioBlock<SampleType>& audioBlock,
-    std::size_t channel = 0u) {
-  WS_PRECONDITION(channel < audioBlock.getNumChannels());
-  std::vector<SampleType> samples(
-      audioBlock.getChannelPointer(channel),
-      audioBlock.getChannelPointer(channel) + audioBlock.getNumSamples());
-  return samples;
-}
-}  // namespace detail
-
 template <class Processor>
 class ProcessorFileIoTest {
 public:
+  using SampleType = float;
+
+  /** @brief The channel count of the output before Spec::numChannels. */
+  [[deprecated(
+      "all channels of the input file are processed by default; set "
+      "Spec::numChannels = 1 to process only the first one")]]
   static constexpr auto CHANNEL_COUNT = 1u;
 
-  using SampleType = float;
+  /** @brief How the file is cut into the blocks process() is called with.
+   */
+  struct BlockSchedule {
+    /** @brief Samples per block; 0 processes the whole file at once. */
+    int blockSize = 0;
+
+    /** @brief If nonzero, every block gets a random size between this and
+     * blockSize, like in hosts whose buffer size varies. */
+    int minBlockSize = 0;
+
+    /** @brief Makes the random block sizes reproducible, also across
+     * standard libraries. */
+    unsigned seed = 0u;
+  };
+
+  /** @brief A change to the processor at a given sample of the input.
+   *
+   * The block that starts at sampleOffset is preceded by a call to apply;
+   * blocks are split so that every event falls on a block boundary.
+   *
+   * @code
+   * {.sampleOffset = 48000, .apply = [](auto& delay) { delay.setDelay(0.5f); }}
+   * @endcode
+   */
+  struct AutomationEvent {
+    std::int64_t sampleOffset = 0;
+    std::function<void(Processor&)> apply;
+  };
 
   struct Spec {
     /** @brief If relative, audioInputFilesDirectoryPath is taken as the parent.
@@ -37,60 +74,537 @@ public:
 
     std::string name = "";
 
+    /** @brief Called right after a processor is prepared, once per
+     * rendering pass; that is twice if the output is rendered again because
+     * it does not match the reference.
+     *
+     * With measureLatencyAndTail, it is also called on the separate
+     * processor instance that renders the impulse response. */
     std::function<void(Processor&)> preProcessCallback = [](auto&) {};
 
     std::string audioInputFilesDirectoryPath = "";
 
     /** @brief If it is empty, then the input file directory is used. */
     std::string audioOutputFilesDirectoryPath = "";
+
+    BlockSchedule blockSchedule{};
+
+    /** @brief Events to apply while rendering, in any order; events at the
+     * same offset are applied in the given order. */
+    std::vector<AutomationEvent> automation{};
+
+    /** @brief Channels to process; 0 processes all channels of the input
+     * file. Channels beyond those of the file repeat them cyclically, e.g.,
+     * a mono file feeds both channels of a stereo processor.
+     *
+     * Only the first channel used to be processed, which 1 still does. */
+    int numChannels = 0;
+
+    /** @brief If true, every process() call is made under
+     * checkRealtimeSafety(), and run() throws on the first one that
+     * allocates, locks, or makes a blocking system call. Requires
+     * WS_DEFINE_REALTIME_SAFETY_HOOKS in one translation unit. */
+    bool checkRealtimeSafety = false;
+
+    /** @brief If true, hardware performance counters are read around every
+     * process() call; see getPerformanceCounters(). */
+    bool readPerformanceCounters = false;
+
+    /** @brief If true, getStatistics() is also written as JSON next to the
+     * output file, with the ".json" extension. It is written on every run,
+     * also if the output matches the reference and is not written, so that
+     * performance regressions show up in the runs that check the audio. */
+    bool writeStatisticsFile = true;
+
+    /** @brief If not empty, the output is compared with this WAV file while
+     * it is rendered and only written if it does not match. If relative,
+     * audioInputFilesDirectoryPath is taken as the parent. */
+    std::string referenceAudioFile = "";
+
+    /** @brief The output matches the reference if no sample differs from it
+     * by more than this. */
+    DecibelsFullScale referenceTolerance{-120.f};
+
+    /** @brief If true, run() also measures the latency and tail length of
+     * the processor from its response to a unit impulse; see
+     * getLatencyAndTail(). run() throws if the processor reports, through
+     * getLatencyInSamples() or getTailLengthSeconds(), a latency other than
+     * the measured one or a shorter tail. */
+    bool measureLatencyAndTail = false;
+
+    /** @brief The tail ends at the last sample at or above this level. */
+    DecibelsFullScale tailThreshold{-80.f};
+
+    /** @brief Length of the impulse response; latency plus tail beyond it
+     * are not measured. */
+    Seconds impulseResponseDuration{5.f};
   };
 
-  explicit ProcessorFileIoTest(Spec spec) : spec_{std::move(spec)} {}
+  struct LatencyAndTail {
+    /** @brief The longest latency and tail of all channels. */
+    ImpulseResponseMeasurement measured;
+
+    /** @brief What getLatencyInSamples() returns, if the processor has it.
+     */
+    std::optional<std::int64_t> reportedLatencyInSamples;
+
+    /** @brief What getTailLengthSeconds() returns, in samples, if the
+     * processor has it. */
+    std::optional<std::int64_t> reportedTailLengthInSamples;
+  };
+
+  explicit ProcessorFileIoTest(Spec spec) : spec_{std::move(spec)} {
+    WS_PRECONDITION(std::ranges::all_of(spec_.automation, [](const auto& e) {
+      return e.sampleOffset >= 0 && e.apply != nullptr;
+    }));
+    std::ranges::stable_sort(spec_.automation, {},
+                             &AutomationEvent::sampleOffset);
+  }
+
+  /** @brief Events that sweep a value linearly from @p from at @p startSample
+   * to @p to at @p endSample, one every @p interval samples and one at
+   * @p endSample.
+   *
+   * @param setValue  called as setValue(processor, value)
+   */
+  template <typename SetValue>
+  [[nodiscard]] static std::vector<AutomationEvent> makeRamp(
+      std::int64_t startSample,
+      std::int64_t endSample,
+      int interval,
+      float from,
+      float to,
+      SetValue setValue) {
+    WS_PRECONDITION(0 <= startSample && startSample <= endSample);
+    WS_PRECONDITION(interval > 0);
+
+    std::vector<AutomationEvent> events;
+    const auto length = static_cast<double>(endSample - startSample);
+    const auto addEvent = [&](std::int64_t offset) {
+      const auto position =
+          length > 0.0 ? static_cast<double>(offset - startSample) / length
+                       : 1.0;
+      const auto value = from + static_cast<float>(position) * (to - from);
+      events.push_back({.sampleOffset = offset,
+                        .apply = [setValue, value](Processor& processor) {
+                          setValue(processor, value);
+                        }});
+    };
+    for (auto offset = startSample; offset < endSample; offset += interval) {
+      addEvent(offset);
+    }
+    // the interval need not divide the length
+    addEvent(endSample);
+    return events;
+  }
 
+  /** @brief Streams the input file through the processor into the output
+   * file.
+   *
+   * With a nonzero BlockSchedule::blockSize, only one block of samples is
+   * held in memory at a time: it is read from the input file, processed in
+   * place, and handed on to the writer. With the default of 0, that block
+   * is the whole file.
+   *
+   * With a reference file, each block is compared with the reference
+   * instead. The output file is then only written if the comparison fails,
+   * by rendering the input once more with a new processor; the block timings
+   * are those of the second pass then.
+   *
+   * @throws std::runtime_error if the input file has no channels or the
+   * reference has a different length or channel count than the output
+   */
   void run() {
-    using namespace juce::dsp;
+    const auto reader = createAudioFormatReader(getInputFile());
+    sampleRate_ = Frequency{static_cast<float>(reader->sampleRate)};
+    lengthInSamples_ = reader->lengthInSamples;
+    numInputChannels_ = static_cast<int>(reader->numChannels);
 
-    // read the input file
-    const auto inputFile = getInputFile();
-    wavReader_.loadFile(inputFile);
+    render([&](std::int64_t start, int numSamples, int numChannels,
+               juce::AudioBuffer<SampleType>& buffer) {
+      if (!reader->read(buffer.getArrayOfWritePointers(), numChannels, start,
+                        numSamples)) {
+        throw std::runtime_error{
+            "failed to read " + getInputFile().getFullPathName().toStdString()};
+      }
+    });
+  }
 
-    // create and prepare the processor
+  /** @brief Like run() but takes the samples from @p input, which must have
+   * loaded getInputFile().
+   *
+   * Lets many tests share one decoded copy of their input file, e.g., through
+   * a DecodedAudioCache; @p input is not modified. Unless
+   * BlockSchedule::blockSize is set, the block processed is a second copy of
+   * the whole file.
+   */
+  void run(const WavFileReader& input) {
+    const auto& samples = input.getSamples();
+    sampleRate_ = input.getSampleRate();
+    lengthInSamples_ = samples.getNumSamples();
+    numInputChannels_ = samples.getNumChannels();
+
+    render([&](std::int64_t start, int numSamples, int numChannels,
+               juce::AudioBuffer<SampleType>& buffer) {
+      for (auto channel = 0; channel < numChannels; ++channel) {
+        buffer.copyFrom(channel, 0, samples, channel, static_cast<int>(start),
+                        numSamples);
+      }
+    });
+  }
+
+  [[nodiscard]] wolfsound::Frequency getSampleRate() const {
+    return sampleRate_;
+  }
+
+  [[nodiscard]] std::size_t getOutputSamplesCount() const {
+    return static_cast<std::size_t>(lengthInSamples_);
+  }
+
+  /** @brief Channels the processor is prepared with and the output has. */
+  [[nodiscard]] int getNumChannels() const {
+    WS_PRECONDITION(spec_.numChannels >= 0);
+    if (spec_.numChannels == 0) {
+      return numInputChannels_;
+    }
+    return spec_.numChannels;
+  }
+
+  /** @brief One entry per process() call of the last run(). */
+  [[nodiscard]] const std::vector<BlockTiming>& getBlockTimings() const {
+    return blockTimings_;
+  }
+
+  /** @brief Cost of the last run(), measured around every process() call.
+   */
+  [[nodiscard]] ProcessingStatistics getStatistics() const {
+    return ProcessingStatistics::from(
+        blockTimings_, static_cast<double>(getSampleRate().value()));
+  }
+
+  /** @brief Events counted over every process() call of the last run();
+   * empty if the spec did not ask for them. */
+  [[nodiscard]] const std::optional<PerformanceCounterValues>&
+  getPerformanceCounters() const {
+    return performanceCounters_;
+  }
+
+  /** @brief The comparison made by the last run(); empty if the spec has no
+   * reference file. */
+  [[nodiscard]] const std::optional<ReferenceComparison::Result>&
+  getReferenceComparison() const {
+    return referenceComparison_;
+  }
+
+  /** @brief The measurement made by the last run(); empty if the spec did
+   * not ask for it. */
+  [[nodiscard]] const std::optional<LatencyAndTail>& getLatencyAndTail()
+      const {
+    return latencyAndTail_;
+  }
+
+  /** @brief True if the last run() was compared with a reference file and
+   * its output matched it. */
+  [[nodiscard]] bool matchesReference() const {
+    return referenceComparison_.has_value() &&
+           referenceComparison_->maxAbsoluteErrorLevel <=
+               spec_.referenceTolerance;
+  }
+
+  [[nodiscard]] juce::File getInputFile() const {
+    return resolveInputPath(spec_.inputAudioFile);
+  }
+
+  [[nodiscard]] std::string getOutputFilePath() const {
+    const auto outputFilename = getOutputFilename();
+
+    if (juce::File::isAbsolutePath(outputFilename)) {
+      return getOutputDirectory()
+          .getChildFile(juce::File{outputFilename}.getFileName())
+          .getFullPathName()
+          .toStdString();
+    }
+
+    return getOutputDirectory()
+        .getChildFile(getOutputFilename())
+        .getFullPathName()
+        .toStdString();
+  }
+
+private:
+  /** @brief Compares the output with the reference, if any, and writes it
+   * unless it matches.
+   *
+   * @param readInput  called as readInput(start, numSamples, numChannels,
+   * buffer) to fill the first numSamples samples of the first numChannels
+   * channels of buffer with the input starting at sample start
+   */
+  template <typename ReadInput>
+  void render(ReadInput&& readInput) {
+    if (numInputChannels_ == 0) {
+      throw std::runtime_error{getInputFile().getFullPathName().toStdString() +
+                               " has no channels"};
+    }
+
+    referenceComparison_.reset();
+    if (!spec_.referenceAudioFile.empty()) {
+      referenceComparison_ = compareWithReference(readInput);
+    }
+
+    if (!matchesReference()) {
+      StreamingWavFileWriter writer{{.absolutePath = getOutputFilePath(),
+                                     .sampleRate = sampleRate_,
+                                     .numChannels = getNumChannels()}};
+      process(readInput, [&](const juce::AudioBuffer<SampleType>& output,
+                             std::int64_t, int numSamples) {
+        writer.append(output.getArrayOfReadPointers(), numSamples);
+      });
+      writer.close();
+    }
+
+    if (spec_.writeStatisticsFile) {
+      writeStatisticsFile();
+    }
+
+    latencyAndTail_.reset();
+    if (spec_.measureLatencyAndTail) {
+      latencyAndTail_ = measureLatencyAndTail();
+      verifyLatencyAndTail(*latencyAndTail_);
+    }
+  }
+
+  /** @brief Renders a unit impulse on all channels with a new processor
+   * prepared like the one of run(), including preProcessCallback, and
+   * measures its response. */
+  [[nodiscard]] LatencyAndTail measureLatencyAndTail() const {
+    using namespace juce::dsp;
+
+    const auto impulse =
+        generateImpulse(sampleRate_, spec_.impulseResponseDuration);
+    const auto length = static_cast<int>(impulse.size());
+    const auto blockSize = spec_.blockSchedule.blockSize > 0
+                               ? spec_.blockSchedule.blockSize
+                               : std::max(1, length);
     Processor processor;
-    processor.prepare(ProcessSpec{
+    prepare(processor, blockSize);
+
+    juce::AudioBuffer<SampleType> response{getNumChannels(), length};
+    for (auto channel = 0; channel < getNumChannels(); ++channel) {
+      response.copyFrom(channel, 0, impulse.data(), length);
+    }
+    AudioBlock<SampleType> responseBlock{response};
+    for (auto start = 0; start < length; start += blockSize) {
+      auto block = responseBlock.getSubBlock(
+          static_cast<std::size_t>(start),
+          static_cast<std::size_t>(std::min(blockSize, length - start)));
+      processor.process(ProcessContextReplacing<SampleType>{block});
+    }
+
+    LatencyAndTail result;
+    for (auto channel = 0; channel < getNumChannels(); ++channel) {
+      const auto measured = ImpulseResponseMeasurement::from(
+          {response.getReadPointer(channel), impulse.size()},
+          spec_.tailThreshold);
+      if (!measured.has_value()) {
+        throw std::runtime_error{
+            "the impulse response of channel " + std::to_string(channel) +
+            " does not reach " + spec_.tailThreshold.toString() + " dBFS"};
+      }
+      result.measured.latencyInSamples = std::max(
+          result.measured.latencyInSamples, measured->latencyInSamples);
+      result.measured.tailLengthInSamples = std::max(
+          result.measured.tailLengthInSamples, measured->tailLengthInSamples);
+      result.measured.peak = std::max(result.measured.peak, measured->peak);
+    }
+
+    if constexpr (requires { processor.getLatencyInSamples(); }) {
+      result.reportedLatencyInSamples = std::llround(
+          static_cast<double>(processor.getLatencyInSamples()));
+    }
+    if constexpr (requires { processor.getTailLengthSeconds(); }) {
+      result.reportedTailLengthInSamples = static_cast<std::int64_t>(
+          std::ceil(static_cast<double>(processor.getTailLengthSeconds()) *
+                    static_cast<double>(sampleRate_.value())));
+    }
+    return result;
+  }
+
+  static void verifyLatencyAndTail(const LatencyAndTail& latencyAndTail) {
+    const auto& [measured, reportedLatency, reportedTail] = latencyAndTail;
+    if (reportedLatency.has_value() &&
+        *reportedLatency != measured.latencyInSamples) {
+      throw std::runtime_error{
+          "the processor reports a latency of " +
+          std::to_string(*reportedLatency) + " samples but has " +
+          std::to_string(measured.latencyInSamples)};
+    }
+    if (reportedTail.has_value() &&
+        *reportedTail < measured.tailLengthInSamples) {
+      throw std::runtime_error{
+          "the processor reports a tail of " + std::to_string(*reportedTail) +
+          " samples but has " + std::to_string(measured.tailLengthInSamples)};
+    }
+  }
+
+  void prepare(Processor& processor, int maximumBlockSize) const {
+    processor.prepare(juce::dsp::ProcessSpec{
         .sampleRate = static_cast<double>(getSampleRate().value()),
-        .maximumBlockSize =
-            static_cast<juce::uint32>(wavReader_.getLengthInSamples()),
-        .numChannels = CHANNEL_COUNT,
+        .maximumBlockSize = static_cast<juce::uint32>(maximumBlockSize),
+        .numChannels = static_cast<juce::uint32>(getNumChannels()),
     });
 
     spec_.preProcessCallback(processor);
+  }
 
-    // render the output
-    auto audioBlock = getAudioBlock();
-    processor.process(ProcessContextReplacing<SampleType>{audioBlock});
+  template <typename ReadInput>
+  [[nodiscard]] ReferenceComparison::Result compareWithReference(
+      ReadInput& readInput) {
+    const auto referenceFile = resolveInputPath(spec_.referenceAudioFile);
+    const auto reference = createAudioFormatReader(referenceFile);
+    if (static_cast<int>(reference->numChannels) != getNumChannels() ||
+        reference->lengthInSamples != lengthInSamples_) {
+      throw std::runtime_error{
+          "reference " + referenceFile.getFullPathName().toStdString() +
+          " does not have the channel count and length of the output"};
+    }
 
-    // write the output to file
-    const auto samples = detail::vectorFromChannel(audioBlock);
-    WavFileWriter::writeToFile(getOutputFilePath(), samples, getSampleRate());
+    ReferenceComparison comparison;
+    juce::AudioBuffer<SampleType> referenceBlock{getNumChannels(),
+                                                 getMaximumBlockSize()};
+    process(readInput, [&](const juce::AudioBuffer<SampleType>& output,
+                           std::int64_t start, int numSamples) {
+      if (!reference->read(referenceBlock.getArrayOfWritePointers(),
+                           getNumChannels(), start, numSamples)) {
+        throw std::runtime_error{
+            "failed to read " + referenceFile.getFullPathName().toStdString()};
+      }
+      for (auto channel = 0; channel < getNumChannels(); ++channel) {
+        comparison.add(output.getReadPointer(channel),
+                       referenceBlock.getReadPointer(channel), numSamples);
+      }
+    });
+    return comparison.getResult();
   }
 
-  [[nodiscard]] wolfsound::Frequency getSampleRate() const {
-    return wavReader_.getSampleRate();
+  /** @brief Runs the processor over the input block by block.
+   *
+   * @param consumeOutput  called as consumeOutput(buffer, start, numSamples)
+   * after each process() call; the output is in the first numSamples samples
+   * of buffer
+   */
+  template <typename ReadInput, typename ConsumeOutput>
+  void process(ReadInput& readInput, ConsumeOutput&& consumeOutput) {
+    using namespace juce::dsp;
+
+    // create and prepare the processor
+    const auto maximumBlockSize = getMaximumBlockSize();
+    Processor processor;
+    prepare(processor, maximumBlockSize);
+
+    // render the output block by block, as a host would
+    juce::AudioBuffer<SampleType> buffer{getNumChannels(), maximumBlockSize};
+    const auto numChannelsRead = std::min(getNumChannels(), numInputChannels_);
+    blockTimings_.clear();
+    std::mt19937 engine{spec_.blockSchedule.seed};
+    auto nextEvent = spec_.automation.begin();
+    // opened here as they count the calling thread only
+    std::optional<PerformanceCounters> counters;
+    if (spec_.readPerformanceCounters) {
+      counters.emplace();
+    }
+    // reused by every block so that checking does not allocate in between
+    std::vector<RealtimeSafetyViolation> violations;
+    if (spec_.checkRealtimeSafety) {
+      violations.reserve(ScopedRealtimeSafetyCheck::MAX_RECORDED_VIOLATIONS);
+    }
+    for (std::int64_t start = 0; start < lengthInSamples_;) {
+      const auto firstEvent = nextEvent;
+      while (nextEvent != spec_.automation.end() &&
+             nextEvent->sampleOffset <= start) {
+        ++nextEvent;
+      }
+      auto blockEnd = std::min<std::int64_t>(
+          start + nextBlockSize(engine, maximumBlockSize), lengthInSamples_);
+      if (nextEvent != spec_.automation.end()) {
+        blockEnd = std::min(blockEnd, nextEvent->sampleOffset);
+      }
+      const auto blockSize = static_cast<int>(blockEnd - start);
+      readInput(start, blockSize, numChannelsRead, buffer);
+      // repeat the file's channels for the extra ones
+      for (auto channel = numChannelsRead; channel < getNumChannels();
+           ++channel) {
+        buffer.copyFrom(channel, 0, buffer, channel % numInputChannels_, 0,
+                        blockSize);
+      }
+      auto block = AudioBlock<SampleType>{buffer}.getSubBlock(
+          0u, static_cast<std::size_t>(blockSize));
+
+      // automation is part of the measured cost of the block it precedes;
+      // the counters are read outside of the real-time safety check
+      if (counters) {
+        counters->start();
+      }
+      blockTimings_.push_back(measureBlock(start, blockSize, [&] {
+        std::for_each(firstEvent, nextEvent,
+                      [&](const auto& event) { event.apply(processor); });
+        const ProcessContextReplacing<SampleType> context{block};
+        if (spec_.checkRealtimeSafety) {
+          wolfsound::checkRealtimeSafety(
+              [&] { processor.process(context); }, violations);
+        } else {
+          processor.process(context);
+        }
+      }));
+      if (counters) {
+        counters->stop();
+      }
+
+      consumeOutput(buffer, start, blockSize);
+      start += blockSize;
+    }
+
+    if (counters) {
+      performanceCounters_ = counters->getTotals();
+    }
   }
 
-  [[nodiscard]] std::size_t getOutputSamplesCount() const {
-    return wavReader_.getLengthInSamples();
+  [[nodiscard]] int getMaximumBlockSize() const {
+    const auto& schedule = spec_.blockSchedule;
+    WS_PRECONDITION(schedule.blockSize >= 0);
+    WS_PRECONDITION(0 <= schedule.minBlockSize &&
+                    schedule.minBlockSize <= schedule.blockSize);
+
+    if (schedule.blockSize == 0) {
+      if (lengthInSamples_ > std::numeric_limits<int>::max()) {
+        throw std::runtime_error{
+            "file too long to be processed in one block; set blockSize"};
+      }
+      return std::max(1, static_cast<int>(lengthInSamples_));
+    }
+    return schedule.blockSize;
   }
 
-private:
-  static constexpr auto FIRST_CHANNEL = 0u;
+  [[nodiscard]] int nextBlockSize(std::mt19937& engine,
+                                  int maximumBlockSize) const {
+    const auto& schedule = spec_.blockSchedule;
+    if (schedule.minBlockSize == 0) {
+      return maximumBlockSize;
+    }
+    // std::mt19937 is fully specified but the distributions are not, so
+    // the range is mapped by hand; its bias is negligible for block sizes
+    const auto numSizes = static_cast<std::uint32_t>(schedule.blockSize -
+                                                     schedule.minBlockSize) +
+                          1u;
+    return schedule.minBlockSize + static_cast<int>(engine() % numSizes);
+  }
 
-  [[nodiscard]] juce::File getInputFile() const {
-    if (!juce::File::isAbsolutePath(spec_.inputAudioFile)) {
+  /** @brief Resolves @p path against audioInputFilesDirectoryPath. */
+  [[nodiscard]] juce::File resolveInputPath(const std::string& path) const {
+    if (!juce::File::isAbsolutePath(path)) {
       juce::File inputDirectory{spec_.audioInputFilesDirectoryPath};
-      return inputDirectory.getChildFile(spec_.inputAudioFile);
+      return inputDirectory.getChildFile(path);
     }
-    return {spec_.inputAudioFile};
+    return {path};
   }
 
   [[nodiscard]] std::string getOutputFilename() const {
@@ -119,31 +633,30 @@ private:
     return getInputDirectory();
   }
 
-  [[nodiscard]] std::string getOutputFilePath() const {
-    const auto outputFilename = getOutputFilename();
-
-    if (juce::File::isAbsolutePath(outputFilename)) {
-      return getOutputDirectory()
-          .getChildFile(juce::File{outputFilename}.getFileName())
-          .getFullPathName()
-          .toStdString();
+  void writeStatisticsFile() const {
+    const auto statisticsFile =
+        juce::File{getOutputFilePath()}.withFileExtension(".json");
+    // not created by the writer if the output matched the reference; a
+    // failure surfaces when writing the file below
+    static_cast<void>(statisticsFile.getParentDirectory().createDirectory());
+    auto statistics = getStatistics().toVar();
+    if (performanceCounters_.has_value()) {
+      statistics.getDynamicObject()->setProperty(
+          "performanceCounters", performanceCounters_->toVar());
+    }
+    if (!statisticsFile.replaceWithText(juce::JSON::toString(statistics))) {
+      throw std::runtime_error{"failed to write " +
+                               statisticsFile.getFullPathName().toStdString()};
     }
-
-    return getOutputDirectory()
-        .getChildFile(getOutputFilename())
-        .getFullPathName()
-        .toStdString();
-  }
-
-  [[nodiscard]] juce::dsp::AudioBlock<SampleType> getAudioBlock() {
-    samplesToProcess_ = wavReader_.getSamples();
-    // take only the first channel
-    return juce::dsp::AudioBlock<SampleType>{samplesToProcess_}
-        .getSubsetChannelBlock(FIRST_CHANNEL, CHANNEL_COUNT);
   }
 
   Spec spec_;
-  WavFileReader wavReader_;
-  juce::AudioBuffer<SampleType> samplesToProcess_;
+  Frequency sampleRate_;
+  std::int64_t lengthInSamples_ = 0;
+  int numInputChannels_ = 0;
+  std::vector<BlockTiming> blockTimings_;
+  std::optional<PerformanceCounterValues> performanceCounters_;
+  std::optional<ReferenceComparison::Result> referenceComparison_;
+  std::optional<LatencyAndTail> latencyAndTail_;
 };
 }  // namespace wolfsound
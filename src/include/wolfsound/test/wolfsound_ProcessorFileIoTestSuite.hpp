@@ -0,0 +1,182 @@
+#pragma once
+
+#include <wolfsound/common/wolfsound_assert.hpp>
+#include <wolfsound/file/wolfsound_DecodedAudioCache.hpp>
+#include <wolfsound/file/wolfsound_WavFileReader.hpp>
+#include <wolfsound/test/wolfsound_PerformanceCounters.hpp>
+#include <wolfsound/test/wolfsound_ProcessingStatistics.hpp>
+#include <wolfsound/test/wolfsound_ProcessorFileIoTest.hpp>
+#include <wolfsound/test/wolfsound_ReferenceComparison.hpp>
+#include <juce_core/juce_core.h>
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <map>
+#include <memory>
+#include <numeric>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace wolfsound {
+struct ProcessorFileIoTestResult {
+  std::string name;
+  juce::File outputFile;
+  /** @brief False if the spec threw or its output did not match its
+   * reference file. */
+  bool succeeded = false;
+  std::string errorMessage;
+  ProcessingStatistics statistics;
+  std::optional<ReferenceComparison::Result> referenceComparison;
+  std::optional<PerformanceCounterValues> performanceCounters;
+};
+
+/** @brief Runs many ProcessorFileIoTest specs concurrently.
+ *
+ * Each input file is decoded once and shared by all specs that process it.
+ * The specs are spread over a pool of threads, each of which takes the next
+ * pending spec when it is done with the previous one; longer inputs are
+ * started first so that no thread is left with a long file at the end.
+ *
+ * The output files and the block sizes of every spec do not depend on the
+ * number of threads. Measured durations do, as the threads compete for the
+ * CPU; BlockTiming::cpuTime is the less affected of the two.
+ *
+ * @code
+ * const auto results = ProcessorFileIoTestSuite<MyProcessor>{}.run(specs);
+ * for (const auto& result : results) {
+ *   EXPECT_TRUE(result.succeeded) << result.name << ": "
+ *                                 << result.errorMessage;
+ * }
+ * @endcode
+ */
+template <class Processor>
+class ProcessorFileIoTestSuite {
+public:
+  using Spec = typename ProcessorFileIoTest<Processor>::Spec;
+
+  static constexpr std::size_t DEFAULT_INPUT_CACHE_SIZE_IN_BYTES = 1u << 30u;
+
+  struct Args {
+    /** @brief Threads to run on, including the calling one. */
+    unsigned numThreads = std::max(1u, std::thread::hardware_concurrency());
+
+    /** @brief Where the decoded input files are kept while in use. */
+    std::shared_ptr<DecodedAudioCache> inputCache =
+        std::make_shared<DecodedAudioCache>(DEFAULT_INPUT_CACHE_SIZE_IN_BYTES);
+
+    /** @brief Block size of the specs whose BlockSchedule::blockSize is 0.
+     * Processing them in one block would hold a copy of the whole input
+     * besides the cached one; 0 does so nonetheless. */
+    int defaultBlockSize = 1024;
+  };
+
+  ProcessorFileIoTestSuite() : ProcessorFileIoTestSuite{Args{}} {}
+
+  explicit ProcessorFileIoTestSuite(Args args) : args_{std::move(args)} {
+    WS_PRECONDITION(args_.inputCache != nullptr);
+    WS_PRECONDITION(args_.defaultBlockSize >= 0);
+  }
+
+  /** @brief Runs all @p specs and blocks until done.
+   *
+   * A spec that fails is reported in its result; the other specs are run
+   * regardless.
+   *
+   * @return one result per spec, in the order of @p specs
+   * @throws std::runtime_error if two specs would write the same output file
+   */
+  [[nodiscard]] std::vector<ProcessorFileIoTestResult> run(
+      std::span<const Spec> specs) const;
+
+private:
+  void runOne(const Spec& spec, ProcessorFileIoTestResult& result) const;
+
+  Args args_;
+};
+
+template <class Processor>
+std::vector<ProcessorFileIoTestResult> ProcessorFileIoTestSuite<Processor>::run(
+    std::span<const Spec> specs) const {
+  std::vector<ProcessorFileIoTestResult> results(specs.size());
+  std::vector<juce::int64> inputSizes(specs.size());
+  std::map<std::string, std::size_t> specsByOutputPath;
+  for (auto i = 0u; i < specs.size(); ++i) {
+    const ProcessorFileIoTest<Processor> test{specs[i]};
+    const auto outputPath = test.getOutputFilePath();
+    if (const auto [it, inserted] = specsByOutputPath.emplace(outputPath, i);
+        !inserted) {
+      throw std::runtime_error{"specs " + std::to_string(it->second) +
+                               " and " + std::to_string(i) +
+                               " both write " + outputPath};
+    }
+
+    results[i].name = specs[i].name;
+    results[i].outputFile = juce::File{outputPath};
+    inputSizes[i] = test.getInputFile().getSize();
+  }
+
+  // longest first; specs of the same file next to each other so that its
+  // decoded samples are still cached when the last of them starts
+  std::vector<std::size_t> order(specs.size());
+  std::iota(order.begin(), order.end(), std::size_t{0});
+  std::ranges::stable_sort(order, [&](std::size_t lhs, std::size_t rhs) {
+    if (inputSizes[lhs] != inputSizes[rhs]) {
+      return inputSizes[lhs] > inputSizes[rhs];
+    }
+    return specs[lhs].inputAudioFile < specs[rhs].inputAudioFile;
+  });
+
+  std::atomic<std::size_t> nextSpec{0u};
+  auto runSpecs = [&] {
+    for (auto i = nextSpec++; i < order.size(); i = nextSpec++) {
+      runOne(specs[order[i]], results[order[i]]);
+    }
+  };
+
+  {
+    const auto numThreads =
+        std::min<std::size_t>(std::max(1u, args_.numThreads), specs.size());
+    std::vector<std::jthread> threads;
+    for (auto i = std::size_t{1}; i < numThreads; ++i) {
+      threads.emplace_back(runSpecs);
+    }
+    runSpecs();
+  }
+
+  return results;
+}
+
+template <class Processor>
+void ProcessorFileIoTestSuite<Processor>::runOne(
+    const Spec& spec,
+    ProcessorFileIoTestResult& result) const {
+  try {
+    auto blockedSpec = spec;
+    if (blockedSpec.blockSchedule.blockSize == 0) {
+      blockedSpec.blockSchedule.blockSize = args_.defaultBlockSize;
+    }
+    ProcessorFileIoTest<Processor> test{blockedSpec};
+    WavFileReader input{{.cache = args_.inputCache}};
+    input.loadFile(test.getInputFile());
+    test.run(input);
+    result.statistics = test.getStatistics();
+    result.referenceComparison = test.getReferenceComparison();
+    result.performanceCounters = test.getPerformanceCounters();
+    result.succeeded =
+        !result.referenceComparison.has_value() || test.matchesReference();
+    if (!result.succeeded) {
+      result.errorMessage =
+          "output differs from the reference by up to " +
+          result.referenceComparison->maxAbsoluteErrorLevel.toString() +
+          " dBFS";
+    }
+  } catch (const std::exception& e) {
+    result.errorMessage = e.what();
+  }
+}
+}  // namespace wolfsound
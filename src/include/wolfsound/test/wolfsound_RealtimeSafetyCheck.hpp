@@ -0,0 +1,452 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace wolfsound {
+struct RealtimeSafetyViolation {
+  /** @brief The intercepted function, e.g., "malloc". */
+  std::string function;
+  std::string stackTrace;
+};
+
+/** @brief Records the calls that are not real-time safe made by the current
+ * thread while an instance is alive.
+ *
+ * Memory allocation and deallocation, mutex locks, and blocking system calls
+ * count as violations: they may take an unbounded amount of time and cause
+ * dropouts. They are intercepted by hooks that must be compiled into exactly
+ * one translation unit of the test executable, by defining
+ * WS_DEFINE_REALTIME_SAFETY_HOOKS before including this header. The hooks
+ * replace the allocation functions of the whole executable, so such tests
+ * are best kept in an executable of their own.
+ *
+ * The C++ allocation functions are intercepted on all platforms; malloc()
+ * and friends, pthread_mutex_lock(), and the system calls only with glibc.
+ * The hooks cost a thread-local lookup per call while no check is active.
+ *
+ * @code
+ * // in one test .cpp file
+ * #define WS_DEFINE_REALTIME_SAFETY_HOOKS
+ * #include <wolfsound/test/wolfsound_RealtimeSafetyCheck.hpp>
+ *
+ * checkRealtimeSafety([&] { processor.processBlock(buffer, midi); });
+ * @endcode
+ */
+class ScopedRealtimeSafetyCheck {
+public:
+  /** @brief Violations beyond this many are counted but not recorded. */
+  static constexpr std::size_t MAX_RECORDED_VIOLATIONS = 8u;
+
+  ScopedRealtimeSafetyCheck() noexcept;
+
+  /** @brief Records into @p storage instead of a vector of its own.
+   *
+   * @p storage is cleared and given room for MAX_RECORDED_VIOLATIONS
+   * violations before the check starts. Reusing it across checks saves
+   * allocating that room every time, e.g., once per processed block.
+   */
+  explicit ScopedRealtimeSafetyCheck(
+      std::vector<RealtimeSafetyViolation>& storage) noexcept;
+
+  ~ScopedRealtimeSafetyCheck();
+
+  ScopedRealtimeSafetyCheck(const ScopedRealtimeSafetyCheck&) = delete;
+  ScopedRealtimeSafetyCheck& operator=(const ScopedRealtimeSafetyCheck&) =
+      delete;
+
+  /** @brief The first MAX_RECORDED_VIOLATIONS violations. */
+  [[nodiscard]] const std::vector<RealtimeSafetyViolation>& getViolations()
+      const noexcept {
+    return *violations_;
+  }
+
+  [[nodiscard]] std::int64_t getNumViolations() const noexcept {
+    return numViolations_;
+  }
+
+  /** @brief True if WS_DEFINE_REALTIME_SAFETY_HOOKS is defined in some
+   * translation unit of the program. */
+  [[nodiscard]] static bool areHooksInstalled() noexcept;
+
+  /** @brief Called by the hooks. */
+  static void report(const char* function) noexcept;
+
+private:
+  void start() noexcept;
+  void record(const char* function) noexcept;
+
+  ScopedRealtimeSafetyCheck* enclosingCheck_;
+  // unused if the storage is passed in
+  std::vector<RealtimeSafetyViolation> ownViolations_;
+  std::vector<RealtimeSafetyViolation>* violations_;
+  std::int64_t numViolations_ = 0;
+};
+
+namespace detail {
+inline thread_local ScopedRealtimeSafetyCheck* activeRealtimeSafetyCheck =
+    nullptr;
+inline std::atomic<bool> realtimeSafetyHooksInstalled{false};
+}  // namespace detail
+
+/** @brief Calls @p function under a ScopedRealtimeSafetyCheck that records
+ * into @p storage; see ScopedRealtimeSafetyCheck's constructor.
+ *
+ * @throws std::runtime_error describing the first violation, with its stack
+ * trace, if there was any, or if the hooks are not installed
+ */
+template <typename Function>
+void checkRealtimeSafety(Function&& function,
+                         std::vector<RealtimeSafetyViolation>& storage) {
+  if (!ScopedRealtimeSafetyCheck::areHooksInstalled()) {
+    throw std::runtime_error{
+        "real-time safety hooks are not installed; define "
+        "WS_DEFINE_REALTIME_SAFETY_HOOKS in one translation unit"};
+  }
+
+  std::int64_t numViolations = 0;
+  RealtimeSafetyViolation firstViolation;
+  {
+    const ScopedRealtimeSafetyCheck check{storage};
+    function();
+    numViolations = check.getNumViolations();
+    if (numViolations > 0) {
+      firstViolation = check.getViolations().front();
+    }
+  }
+
+  if (numViolations > 0) {
+    throw std::runtime_error{std::to_string(numViolations) +
+                             " real-time safety violation(s), the first in " +
+                             firstViolation.function + " called from\n" +
+                             firstViolation.stackTrace};
+  }
+}
+
+/** @brief Calls @p function under a ScopedRealtimeSafetyCheck.
+ *
+ * @throws std::runtime_error describing the first violation, with its stack
+ * trace, if there was any, or if the hooks are not installed
+ */
+template <typename Function>
+void checkRealtimeSafety(Function&& function) {
+  std::vector<RealtimeSafetyViolation> storage;
+  checkRealtimeSafety(std::forward<Function>(function), storage);
+}
+
+inline ScopedRealtimeSafetyCheck::ScopedRealtimeSafetyCheck() noexcept
+    : enclosingCheck_{detail::activeRealtimeSafetyCheck},
+      violations_{&ownViolations_} {
+  start();
+}
+
+inline ScopedRealtimeSafetyCheck::ScopedRealtimeSafetyCheck(
+    std::vector<RealtimeSafetyViolation>& storage) noexcept
+    : enclosingCheck_{detail::activeRealtimeSafetyCheck},
+      violations_{&storage} {
+  start();
+}
+
+inline void ScopedRealtimeSafetyCheck::start() noexcept {
+  // reserved up front so that recording does not reallocate
+  detail::activeRealtimeSafetyCheck = nullptr;
+  violations_->clear();
+  try {
+    violations_->reserve(MAX_RECORDED_VIOLATIONS);
+  } catch (...) {
+  }
+  detail::activeRealtimeSafetyCheck = this;
+}
+
+inline ScopedRealtimeSafetyCheck::~ScopedRealtimeSafetyCheck() {
+  detail::activeRealtimeSafetyCheck = enclosingCheck_;
+}
+
+inline bool ScopedRealtimeSafetyCheck::areHooksInstalled() noexcept {
+  return detail::realtimeSafetyHooksInstalled.load(std::memory_order_relaxed);
+}
+
+inline void ScopedRealtimeSafetyCheck::report(const char* function) noexcept {
+  if (auto* check = detail::activeRealtimeSafetyCheck) {
+    // recording allocates; it must not be reported itself
+    detail::activeRealtimeSafetyCheck = nullptr;
+    check->record(function);
+    detail::activeRealtimeSafetyCheck = check;
+  }
+}
+
+inline void ScopedRealtimeSafetyCheck::record(const char* function) noexcept {
+  ++numViolations_;
+  if (violations_->size() >= MAX_RECORDED_VIOLATIONS) {
+    return;
+  }
+  try {
+    violations_->push_back(
+        {.function = function,
+         .stackTrace = juce::SystemStats::getStackBacktrace().toStdString()});
+  } catch (...) {
+    // out of memory; the violation is still counted
+  }
+}
+}  // namespace wolfsound
+
+#ifdef WS_DEFINE_REALTIME_SAFETY_HOOKS
+#include <cstdlib>
+#include <new>
+
+#if defined(__linux__) && defined(__GLIBC__)
+#include <dlfcn.h>
+#include <poll.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#define WS_HAS_LIBC_REALTIME_SAFETY_HOOKS 1
+#else
+#define WS_HAS_LIBC_REALTIME_SAFETY_HOOKS 0
+#endif
+
+#if WS_HAS_LIBC_REALTIME_SAFETY_HOOKS
+extern "C" {
+void* __libc_malloc(std::size_t size);
+void* __libc_calloc(std::size_t count, std::size_t size);
+void* __libc_realloc(void* pointer, std::size_t size);
+void* __libc_memalign(std::size_t alignment, std::size_t size);
+void __libc_free(void* pointer);
+}
+#endif
+
+namespace wolfsound::detail {
+inline const bool realtimeSafetyHooksRegistered = [] {
+  realtimeSafetyHooksInstalled = true;
+  return true;
+}();
+
+// the C++ allocation functions bypass the malloc() hooks so that every
+// allocation is reported once
+inline void* allocateUnchecked(std::size_t size) noexcept {
+#if WS_HAS_LIBC_REALTIME_SAFETY_HOOKS
+  return __libc_malloc(size == 0u ? 1u : size);
+#else
+  return std::malloc(size == 0u ? 1u : size);
+#endif
+}
+
+inline void* allocateAlignedUnchecked(std::size_t size,
+                                      std::align_val_t alignment) noexcept {
+  const auto bytes = static_cast<std::size_t>(alignment);
+#if WS_HAS_LIBC_REALTIME_SAFETY_HOOKS
+  return __libc_memalign(bytes, size == 0u ? 1u : size);
+#else
+  // std::aligned_alloc() requires a multiple of the alignment
+  return std::aligned_alloc(bytes, (size + bytes) / bytes * bytes);
+#endif
+}
+
+inline void freeUnchecked(void* pointer) noexcept {
+#if WS_HAS_LIBC_REALTIME_SAFETY_HOOKS
+  __libc_free(pointer);
+#else
+  std::free(pointer);
+#endif
+}
+
+inline void* checkedNew(std::size_t size) {
+  ScopedRealtimeSafetyCheck::report("operator new");
+  if (auto* pointer = allocateUnchecked(size)) {
+    return pointer;
+  }
+  throw std::bad_alloc{};
+}
+
+inline void* checkedNew(std::size_t size, std::align_val_t alignment) {
+  ScopedRealtimeSafetyCheck::report("operator new");
+  if (auto* pointer = allocateAlignedUnchecked(size, alignment)) {
+    return pointer;
+  }
+  throw std::bad_alloc{};
+}
+
+inline void checkedDelete(void* pointer) noexcept {
+  if (pointer != nullptr) {
+    ScopedRealtimeSafetyCheck::report("operator delete");
+    freeUnchecked(pointer);
+  }
+}
+
+#if WS_HAS_LIBC_REALTIME_SAFETY_HOOKS
+/** @brief The next definition of @p name after this executable's, i.e.,
+ * libc's.
+ *
+ * @p cache is constant-initialized: a static with a dynamic initializer
+ * would be guarded by a lock, which may be the very pthread_mutex_lock()
+ * being resolved.
+ */
+template <typename Function>
+[[nodiscard]] Function* nextSymbol(std::atomic<Function*>& cache,
+                                   const char* name) noexcept {
+  auto* function = cache.load(std::memory_order_relaxed);
+  if (function == nullptr) {
+    function = reinterpret_cast<Function*>(dlsym(RTLD_NEXT, name));
+    cache.store(function, std::memory_order_relaxed);
+  }
+  return function;
+}
+#endif
+}  // namespace wolfsound::detail
+
+void* operator new(std::size_t size) {
+  return wolfsound::detail::checkedNew(size);
+}
+void* operator new[](std::size_t size) {
+  return wolfsound::detail::checkedNew(size);
+}
+void* operator new(std::size_t size, std::align_val_t alignment) {
+  return wolfsound::detail::checkedNew(size, alignment);
+}
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+  return wolfsound::detail::checkedNew(size, alignment);
+}
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+  wolfsound::ScopedRealtimeSafetyCheck::report("operator new");
+  return wolfsound::detail::allocateUnchecked(size);
+}
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+  wolfsound::ScopedRealtimeSafetyCheck::report("operator new");
+  return wolfsound::detail::allocateUnchecked(size);
+}
+void* operator new(std::size_t size,
+                   std::align_val_t alignment,
+                   const std::nothrow_t&) noexcept {
+  wolfsound::ScopedRealtimeSafetyCheck::report("operator new");
+  return wolfsound::detail::allocateAlignedUnchecked(size, alignment);
+}
+void* operator new[](std::size_t size,
+                     std::align_val_t alignment,
+                     const std::nothrow_t&) noexcept {
+  wolfsound::ScopedRealtimeSafetyCheck::report("operator new");
+  return wolfsound::detail::allocateAlignedUnchecked(size, alignment);
+}
+
+void operator delete(void* pointer) noexcept {
+  wolfsound::detail::checkedDelete(pointer);
+}
+void operator delete[](void* pointer) noexcept {
+  wolfsound::detail::checkedDelete(pointer);
+}
+void operator delete(void* pointer, std::size_t) noexcept {
+  wolfsound::detail::checkedDelete(pointer);
+}
+void operator delete[](void* pointer, std::size_t) noexcept {
+  wolfsound::detail::checkedDelete(pointer);
+}
+void operator delete(void* pointer, std::align_val_t) noexcept {
+  wolfsound::detail::checkedDelete(pointer);
+}
+void operator delete[](void* pointer, std::align_val_t) noexcept {
+  wolfsound::detail::checkedDelete(pointer);
+}
+void operator delete(void* pointer, std::size_t, std::align_val_t) noexcept {
+  wolfsound::detail::checkedDelete(pointer);
+}
+void operator delete[](void* pointer, std::size_t, std::align_val_t) noexcept {
+  wolfsound::detail::checkedDelete(pointer);
+}
+void operator delete(void* pointer, const std::nothrow_t&) noexcept {
+  wolfsound::detail::checkedDelete(pointer);
+}
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept {
+  wolfsound::detail::checkedDelete(pointer);
+}
+void operator delete(void* pointer,
+                     std::align_val_t,
+                     const std::nothrow_t&) noexcept {
+  wolfsound::detail::checkedDelete(pointer);
+}
+void operator delete[](void* pointer,
+                       std::align_val_t,
+                       const std::nothrow_t&) noexcept {
+  wolfsound::detail::checkedDelete(pointer);
+}
+
+#if WS_HAS_LIBC_REALTIME_SAFETY_HOOKS
+extern "C" {
+void* malloc(std::size_t size) noexcept {
+  wolfsound::ScopedRealtimeSafetyCheck::report("malloc");
+  return __libc_malloc(size);
+}
+
+void* calloc(std::size_t count, std::size_t size) noexcept {
+  wolfsound::ScopedRealtimeSafetyCheck::report("calloc");
+  return __libc_calloc(count, size);
+}
+
+void* realloc(void* pointer, std::size_t size) noexcept {
+  wolfsound::ScopedRealtimeSafetyCheck::report("realloc");
+  return __libc_realloc(pointer, size);
+}
+
+void free(void* pointer) noexcept {
+  if (pointer != nullptr) {
+    wolfsound::ScopedRealtimeSafetyCheck::report("free");
+  }
+  __libc_free(pointer);
+}
+
+int pthread_mutex_lock(pthread_mutex_t* mutex) noexcept {
+  using Function = int(pthread_mutex_t*);
+  static std::atomic<Function*> next{nullptr};
+  wolfsound::ScopedRealtimeSafetyCheck::report("pthread_mutex_lock");
+  return wolfsound::detail::nextSymbol(next, "pthread_mutex_lock")(mutex);
+}
+
+ssize_t read(int fd, void* buffer, std::size_t count) {
+  using Function = ssize_t(int, void*, std::size_t);
+  static std::atomic<Function*> next{nullptr};
+  wolfsound::ScopedRealtimeSafetyCheck::report("read");
+  return wolfsound::detail::nextSymbol(next, "read")(fd, buffer, count);
+}
+
+ssize_t write(int fd, const void* buffer, std::size_t count) {
+  using Function = ssize_t(int, const void*, std::size_t);
+  static std::atomic<Function*> next{nullptr};
+  wolfsound::ScopedRealtimeSafetyCheck::report("write");
+  return wolfsound::detail::nextSymbol(next, "write")(fd, buffer, count);
+}
+
+int nanosleep(const timespec* duration, timespec* remaining) {
+  using Function = int(const timespec*, timespec*);
+  static std::atomic<Function*> next{nullptr};
+  wolfsound::ScopedRealtimeSafetyCheck::report("nanosleep");
+  return wolfsound::detail::nextSymbol(next, "nanosleep")(duration,
+                                                          remaining);
+}
+
+int usleep(useconds_t microseconds) {
+  using Function = int(useconds_t);
+  static std::atomic<Function*> next{nullptr};
+  wolfsound::ScopedRealtimeSafetyCheck::report("usleep");
+  return wolfsound::detail::nextSymbol(next, "usleep")(microseconds);
+}
+
+int poll(pollfd* fds, nfds_t numFds, int timeout) {
+  using Function = int(pollfd*, nfds_t, int);
+  static std::atomic<Function*> next{nullptr};
+  wolfsound::ScopedRealtimeSafetyCheck::report("poll");
+  return wolfsound::detail::nextSymbol(next, "poll")(fds, numFds, timeout);
+}
+
+int fsync(int fd) {
+  using Function = int(int);
+  static std::atomic<Function*> next{nullptr};
+  wolfsound::ScopedRealtimeSafetyCheck::report("fsync");
+  return wolfsound::detail::nextSymbol(next, "fsync")(fd);
+}
+}
+#endif
+#endif
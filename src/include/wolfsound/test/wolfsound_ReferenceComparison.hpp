@@ -0,0 +1,116 @@
+#pragma once
+
+#include <wolfsound/common/wolfsound_DecibelsFullScale.hpp>
+#include <wolfsound/common/wolfsound_assert.hpp>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+
+namespace wolfsound {
+/** @brief Accumulates the difference between a rendered signal and its
+ * reference, e.g., a golden file, block by block.
+ *
+ * Every level is reported relative to full scale (1.0), so a perfect null
+ * has a maximum error and null depth of ReferenceComparison::SILENCE. The
+ * sums are kept in independent lanes so that the compiler can vectorize the
+ * loop.
+ */
+class ReferenceComparison {
+public:
+  /** @brief Level reported for a difference of exactly 0; also the upper
+   * bound of the signal-to-noise ratio. */
+  static constexpr DecibelsFullScale SILENCE{-240.f};
+
+  struct Result {
+    std::int64_t numSamples = 0;
+    float maxAbsoluteError = 0.f;
+    /** @brief maxAbsoluteError in dBFS. */
+    DecibelsFullScale maxAbsoluteErrorLevel = SILENCE;
+    /** @brief Energy of the reference over the energy of the difference. */
+    DecibelsFullScale signalToNoiseRatio = -SILENCE;
+    /** @brief RMS level of the difference, i.e., of the rendered signal
+     * minus the reference. */
+    DecibelsFullScale nullDepth = SILENCE;
+  };
+
+  /** @brief Adds @p numSamples samples of one channel. */
+  void add(const float* rendered,
+           const float* reference,
+           int numSamples) noexcept;
+
+  [[nodiscard]] Result getResult() const noexcept;
+
+private:
+  static constexpr auto LANES = 8;
+
+  template <typename T>
+  using Lanes = std::array<T, LANES>;
+
+  void addToLane(int lane, float rendered, float reference) noexcept {
+    const auto error = rendered - reference;
+    errorEnergy_[lane] += static_cast<double>(error) * error;
+    referenceEnergy_[lane] += static_cast<double>(reference) * reference;
+    maxAbsoluteError_[lane] =
+        std::max(maxAbsoluteError_[lane], std::abs(error));
+  }
+
+  Lanes<double> errorEnergy_{};
+  Lanes<double> referenceEnergy_{};
+  Lanes<float> maxAbsoluteError_{};
+  std::int64_t numSamples_ = 0;
+};
+
+namespace detail {
+[[nodiscard]] inline DecibelsFullScale powerRatioToDecibels(double ratio) {
+  const auto silence =
+      static_cast<double>(ReferenceComparison::SILENCE.value());
+  const auto decibels = ratio > 0.0 ? 10.0 * std::log10(ratio) : silence;
+  return DecibelsFullScale{
+      static_cast<float>(std::clamp(decibels, silence, -silence))};
+}
+}  // namespace detail
+
+inline void ReferenceComparison::add(const float* rendered,
+                                     const float* reference,
+                                     int numSamples) noexcept {
+  WS_PRECONDITION(numSamples >= 0);
+  auto i = 0;
+  for (; i + LANES <= numSamples; i += LANES) {
+    for (auto lane = 0; lane < LANES; ++lane) {
+      addToLane(lane, rendered[i + lane], reference[i + lane]);
+    }
+  }
+  for (auto lane = 0; i + lane < numSamples; ++lane) {
+    addToLane(lane, rendered[i + lane], reference[i + lane]);
+  }
+  numSamples_ += numSamples;
+}
+
+inline auto ReferenceComparison::getResult() const noexcept -> Result {
+  if (numSamples_ == 0) {
+    return {};
+  }
+
+  auto errorEnergy = 0.0;
+  auto referenceEnergy = 0.0;
+  auto maxAbsoluteError = 0.f;
+  for (auto lane = 0; lane < LANES; ++lane) {
+    errorEnergy += errorEnergy_[lane];
+    referenceEnergy += referenceEnergy_[lane];
+    maxAbsoluteError = std::max(maxAbsoluteError, maxAbsoluteError_[lane]);
+  }
+
+  const auto signalToNoiseRatio =
+      errorEnergy > 0.0
+          ? detail::powerRatioToDecibels(referenceEnergy / errorEnergy)
+          : -SILENCE;
+  return {.numSamples = numSamples_,
+          .maxAbsoluteError = maxAbsoluteError,
+          .maxAbsoluteErrorLevel = detail::powerRatioToDecibels(
+              static_cast<double>(maxAbsoluteError) * maxAbsoluteError),
+          .signalToNoiseRatio = signalToNoiseRatio,
+          .nullDepth = detail::powerRatioToDecibels(
+              errorEnergy / static_cast<double>(numSamples_))};
+}
+}  // namespace wolfsound
@@ -59,6 +59,7 @@
 */
 
 #pragma once
+#include <wolfsound/test/wolfsound_RealtimeSafetyCheck.hpp>
 // use juce_audio_processors instead of juce_audio_processors_headless
 // for backward compatibility
 #include <juce_audio_processors/juce_audio_processors.h>
@@ -84,5 +85,19 @@ public:
   void changeProgramName(int, const juce::String&) override {}
   void getStateInformation(juce::MemoryBlock&) override {}
   void setStateInformation(const void*, int) override {}
+
+  /** @brief Calls processBlock() under checkRealtimeSafety().
+   *
+   * @throws std::runtime_error on the first allocation, lock, or blocking
+   * system call that processBlock() makes
+   */
+  void processBlockRealtimeSafely(juce::AudioBuffer<float>& buffer,
+                                  juce::MidiBuffer& midiMessages) {
+    checkRealtimeSafety([&] { processBlock(buffer, midiMessages); },
+                        realtimeSafetyViolations_);
+  }
+
+private:
+  std::vector<RealtimeSafetyViolation> realtimeSafetyViolations_;
 };
 }  // namespace wolfsound
\ No newline at end of file
@@ -0,0 +1,251 @@
+#pragma once
+
+#include <wolfsound/common/wolfsound_Frequency.hpp>
+#include <wolfsound/common/wolfsound_assert.hpp>
+#include <wolfsound/dsp/wolfsound_testSignals.hpp>
+#include <wolfsound/test/wolfsound_ProcessingStatistics.hpp>
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <algorithm>
+#include <chrono>
+#include <cerrno>
+#include <cmath>
+#include <cstdint>
+#include <exception>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#endif
+
+namespace wolfsound {
+/** @brief Drives a juce::AudioProcessor like an audio device would, without
+ * audio hardware.
+ *
+ * Callbacks are made from a dedicated thread at the cadence of the chosen
+ * sample rate and block size: callback k is due blockSize * k / sampleRate
+ * seconds after the start. On Linux, the thread is scheduled with
+ * SCHED_FIFO when the process is permitted to, e.g., with CAP_SYS_NICE or
+ * an rtprio limit, and sleeps with clock_nanosleep() on absolute deadlines.
+ *
+ * A callback that has not finished by the time the next one is due is an
+ * xrun. As a device would, the clock then skips the periods that have
+ * already passed.
+ *
+ * @code
+ * const auto report = VirtualAudioDevice{{.blockSize = 64}}.run(processor);
+ * EXPECT_EQ(0, report.numXruns);
+ * @endcode
+ */
+class VirtualAudioDevice {
+public:
+  struct Args {
+    double sampleRate = 48000.0;
+    int blockSize = 256;
+    int numInputChannels = 2;
+    int numOutputChannels = 2;
+    Seconds duration{10.f};
+
+    /** @brief SCHED_FIFO priority of the callback thread; 0 keeps the
+     * default scheduling. */
+    int realtimePriority = 80;
+  };
+
+  struct Report {
+    /** @brief True if the callback thread ran with SCHED_FIFO. */
+    bool realtimePriorityGranted = false;
+
+    std::int64_t numCallbacks = 0;
+    std::int64_t numXruns = 0;
+
+    /** @brief How late the callbacks started. */
+    LatencyPercentiles jitter{};
+
+    /** @brief Processing time of the callbacks; numBlocksOverBudget counts
+     * those that took longer than a period. */
+    ProcessingStatistics statistics{};
+
+    [[nodiscard]] juce::var toVar() const;
+  };
+
+  VirtualAudioDevice() : VirtualAudioDevice{Args{}} {}
+
+  explicit VirtualAudioDevice(Args args) : args_{args} {}
+
+  /** @brief Prepares @p processor, calls it back for Args::duration, and
+   * releases it.
+   *
+   * The input channels carry looped white noise.
+   *
+   * @throws std::runtime_error if the processor does not support the
+   * channel layout
+   * @throws whatever the processor throws; it is released first
+   */
+  [[nodiscard]] Report run(juce::AudioProcessor& processor) const;
+
+private:
+  using Clock = std::chrono::steady_clock;
+
+  void runCallbacks(juce::AudioProcessor& processor, Report& report) const;
+
+  Args args_;
+};
+
+namespace detail {
+/** @brief Gives the calling thread the SCHED_FIFO @p priority, clamped to
+ * the valid range.
+ *
+ * @return false if the process is not permitted to or the platform has no
+ * SCHED_FIFO
+ */
+inline bool setRealtimePriority(int priority) noexcept {
+#if defined(__linux__)
+  sched_param parameters{};
+  parameters.sched_priority =
+      std::clamp(priority, sched_get_priority_min(SCHED_FIFO),
+                 sched_get_priority_max(SCHED_FIFO));
+  return pthread_setschedparam(pthread_self(), SCHED_FIFO, &parameters) == 0;
+#else
+  return false;
+#endif
+}
+
+/** @brief Sleeps until @p deadline, which must be of the steady clock. */
+inline void sleepUntil(std::chrono::steady_clock::time_point deadline) {
+#if defined(__linux__)
+  // libstdc++'s steady_clock is CLOCK_MONOTONIC
+  const auto sinceEpoch = deadline.time_since_epoch();
+  const auto seconds =
+      std::chrono::duration_cast<std::chrono::seconds>(sinceEpoch);
+  timespec time{};
+  time.tv_sec = static_cast<time_t>(seconds.count());
+  time.tv_nsec = static_cast<long>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(sinceEpoch -
+                                                           seconds)
+          .count());
+  // on any error other than an interruption by a signal, e.g., EINVAL,
+  // retrying would spin forever
+  while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &time, nullptr) ==
+         EINTR) {
+  }
+#else
+  std::this_thread::sleep_until(deadline);
+#endif
+}
+}  // namespace detail
+
+inline juce::var VirtualAudioDevice::Report::toVar() const {
+  const juce::DynamicObject::Ptr object{new juce::DynamicObject};
+  object->setProperty("realtimePriorityGranted", realtimePriorityGranted);
+  object->setProperty("numCallbacks", static_cast<juce::int64>(numCallbacks));
+  object->setProperty("numXruns", static_cast<juce::int64>(numXruns));
+  object->setProperty("jitter", jitter.toVar());
+  object->setProperty("statistics", statistics.toVar());
+  return juce::var{object};
+}
+
+inline auto VirtualAudioDevice::run(juce::AudioProcessor& processor) const
+    -> Report {
+  WS_PRECONDITION(args_.sampleRate > 0.0);
+  WS_PRECONDITION(args_.blockSize > 0);
+
+  processor.setPlayConfigDetails(args_.numInputChannels,
+                                 args_.numOutputChannels, args_.sampleRate,
+                                 args_.blockSize);
+  if (processor.getTotalNumInputChannels() != args_.numInputChannels ||
+      processor.getTotalNumOutputChannels() != args_.numOutputChannels) {
+    throw std::runtime_error{"the processor does not support the layout"};
+  }
+  processor.setNonRealtime(false);
+  processor.prepareToPlay(args_.sampleRate, args_.blockSize);
+
+  Report report;
+  std::exception_ptr error;
+  std::jthread{[&] {
+    try {
+      runCallbacks(processor, report);
+    } catch (...) {
+      // rethrown below; escaping the thread would terminate the process
+      error = std::current_exception();
+    }
+  }}.join();
+
+  processor.releaseResources();
+  if (error) {
+    std::rethrow_exception(error);
+  }
+  return report;
+}
+
+inline void VirtualAudioDevice::runCallbacks(juce::AudioProcessor& processor,
+                                             Report& report) const {
+  using namespace std::chrono_literals;
+
+  if (args_.realtimePriority > 0) {
+    report.realtimePriorityGranted =
+        detail::setRealtimePriority(args_.realtimePriority);
+  }
+
+  // allocate everything before the first callback
+  const auto sampleRate = Frequency{static_cast<float>(args_.sampleRate)};
+  const auto input = generateWhiteNoise(sampleRate, 1s, 1u);
+  const auto inputLength = static_cast<int>(input.size());
+  const auto numInputBlocks = std::max(inputLength / args_.blockSize, 1);
+  juce::AudioBuffer<float> buffer{
+      std::max(args_.numInputChannels, args_.numOutputChannels),
+      args_.blockSize};
+  juce::MidiBuffer midiMessages;
+
+  const auto numSamples = std::llround(
+      static_cast<double>(args_.duration.count()) * args_.sampleRate);
+  const auto numCallbacks =
+      (numSamples + args_.blockSize - 1) / args_.blockSize;
+  std::vector<BlockTiming> timings;
+  std::vector<std::chrono::nanoseconds> lateness;
+  timings.reserve(static_cast<std::size_t>(numCallbacks));
+  lateness.reserve(static_cast<std::size_t>(numCallbacks));
+
+  // computed from the start rather than accumulated, so that the cadence
+  // does not drift
+  const auto start = Clock::now();
+  const auto dueTime = [&](std::int64_t period) {
+    return start + std::chrono::nanoseconds{std::llround(
+                       static_cast<double>(period * args_.blockSize) * 1e9 /
+                       args_.sampleRate)};
+  };
+
+  std::int64_t period = 0;
+  for (std::int64_t callback = 0; callback < numCallbacks; ++callback) {
+    const auto due = dueTime(period);
+    detail::sleepUntil(due);
+    lateness.push_back(Clock::now() - due);
+
+    buffer.clear();
+    const auto inputStart =
+        static_cast<int>((callback % numInputBlocks) * args_.blockSize);
+    for (auto channel = 0; channel < args_.numInputChannels; ++channel) {
+      buffer.copyFrom(channel, 0, input.data() + inputStart,
+                      std::min(args_.blockSize, inputLength - inputStart));
+    }
+    midiMessages.clear();
+    timings.push_back(
+        measureBlock(callback * args_.blockSize, args_.blockSize,
+                     [&] { processor.processBlock(buffer, midiMessages); }));
+
+    ++period;
+    const auto finished = Clock::now();
+    if (finished > dueTime(period)) {
+      ++report.numXruns;
+      while (dueTime(period) < finished) {
+        ++period;
+      }
+    }
+  }
+
+  report.numCallbacks = numCallbacks;
+  report.jitter = LatencyPercentiles::from(std::move(lateness));
+  report.statistics = ProcessingStatistics::from(timings, args_.sampleRate);
+}
+}  // namespace wolfsound
@@ -0,0 +1,111 @@
+#define WS_ENABLE_TRACING
+#include <gtest/gtest.h>
+#include <wolfsound/common/wolfsound_Tracer.hpp>
+#include <latch>
+#include <sstream>
+#include <string>
+#include <thread>
+
+namespace wolfsound {
+namespace {
+std::string exportTrace() {
+  std::ostringstream trace;
+  Tracer::getInstance().writeChromeTrace(trace);
+  return trace.str();
+}
+}  // namespace
+
+TEST(Tracer, ExportsNestedScopesAsCompleteEvents) {
+  // given
+  Tracer::getInstance().clear();
+
+  // when
+  {
+    WS_TRACE_SCOPE("outer");
+    {
+      WS_TRACE_SCOPE("inner \"quoted\"");
+    }
+  }
+  const auto trace = exportTrace();
+
+  // then
+  EXPECT_NE(std::string::npos, trace.find(R"({"name":"outer","ph":"X")"));
+  EXPECT_NE(std::string::npos, trace.find(R"("name":"inner \"quoted\"")"));
+  // the inner scope ends first
+  EXPECT_LT(trace.find("inner"), trace.find("outer"));
+  EXPECT_NE(std::string::npos, trace.find(R"("droppedEvents":0)"));
+}
+
+TEST(Tracer, SeparatesThreadsAndRemovesExportedEvents) {
+  // given
+  Tracer::getInstance().clear();
+
+  // when
+  std::jthread{[] {
+    Tracer::getInstance().prepareCurrentThread("worker");
+    WS_TRACE_SCOPE("work");
+  }}.join();
+  const auto trace = exportTrace();
+
+  // then
+  EXPECT_NE(std::string::npos, trace.find(R"("args":{"name":"worker"})"));
+  EXPECT_NE(std::string::npos, trace.find(R"("name":"work")"));
+  EXPECT_EQ(std::string::npos, exportTrace().find(R"("name":"work")"));
+}
+
+TEST(Tracer, FreesTheBufferOfAnExitedThreadOnceExported) {
+  // given
+  Tracer::getInstance().clear();
+  const auto numBuffers = Tracer::getInstance().getNumThreadBuffers();
+
+  // when
+  std::jthread{[] { WS_TRACE_SCOPE("short-lived"); }}.join();
+  const auto numBuffersBeforeExport =
+      Tracer::getInstance().getNumThreadBuffers();
+  const auto trace = exportTrace();
+
+  // then
+  EXPECT_EQ(numBuffers + 1u, numBuffersBeforeExport);
+  EXPECT_NE(std::string::npos, trace.find(R"("name":"short-lived")"));
+  EXPECT_EQ(numBuffers, Tracer::getInstance().getNumThreadBuffers());
+}
+
+TEST(Tracer, KeepsTheBufferOfARunningThread) {
+  // given
+  Tracer::getInstance().clear();
+  const auto numBuffers = Tracer::getInstance().getNumThreadBuffers();
+  std::latch traced{1};
+  std::latch exported{1};
+  std::jthread worker{[&] {
+    Tracer::getInstance().prepareCurrentThread();
+    traced.count_down();
+    exported.wait();
+  }};
+  traced.wait();
+
+  // when
+  static_cast<void>(exportTrace());
+
+  // then
+  EXPECT_EQ(numBuffers + 1u, Tracer::getInstance().getNumThreadBuffers());
+
+  // cleanup
+  exported.count_down();
+  worker.join();
+  Tracer::getInstance().clear();
+}
+
+TEST(Tracer, DropsEventsWhenTheBufferIsFull) {
+  // given
+  Tracer::getInstance().clear();
+
+  // when
+  for (auto i = 0u; i < Tracer::EVENTS_PER_THREAD + 3u; ++i) {
+    WS_TRACE_SCOPE("event");
+  }
+  const auto trace = exportTrace();
+
+  // then
+  EXPECT_NE(std::string::npos, trace.find(R"("droppedEvents":3)"));
+}
+}  // namespace wolfsound
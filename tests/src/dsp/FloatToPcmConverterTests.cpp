@@ -0,0 +1,101 @@
+#include <gtest/gtest.h>
+#include <wolfsound/dsp/wolfsound_FloatToPcmConverter.hpp>
+#include <wolfsound/dsp/wolfsound_testSignals.hpp>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace wolfsound {
+namespace {
+constexpr auto LSB_16 = 1.f / 32768.f;
+
+std::vector<std::int32_t> convert(FloatToPcmConverter& converter,
+                                  const std::vector<float>& input) {
+  std::vector<std::int32_t> output(input.size());
+  converter.convert(input.data(), output.data(), std::ssize(input), 0);
+  for (auto& sample : output) {
+    sample >>= 32 - converter.getBitsPerSample();
+  }
+  return output;
+}
+}  // namespace
+
+TEST(FloatToPcmConverter, RoundsToNearestAndClips) {
+  // given
+  FloatToPcmConverter converter{{.bitsPerSample = 16, .dither = false}};
+  const std::vector<float> input{
+      0.f, 0.4f * LSB_16, 0.6f * LSB_16, -0.6f * LSB_16, 0.5f, -1.f, 1.f, 2.f,
+      -2.f};
+
+  // when
+  const auto output = convert(converter, input);
+
+  // then
+  const std::vector<std::int32_t> expected{
+      0, 0, 1, -1, 16384, -32768, 32767, 32767, -32768};
+  EXPECT_EQ(expected, output);
+}
+
+TEST(FloatToPcmConverter, LeftJustifies24BitSamples) {
+  // given
+  FloatToPcmConverter converter{{.bitsPerSample = 24, .dither = false}};
+  const float input[] = {0.5f, -1.f};
+  std::int32_t output[2];
+
+  // when
+  converter.convert(input, output, 2, 0);
+
+  // then
+  EXPECT_EQ(0x40000000, output[0]);
+  EXPECT_EQ(INT32_MIN, output[1]);
+}
+
+TEST(FloatToPcmConverter, DitherPreservesLevelsBelowOneLsb) {
+  // given
+  const std::vector<float> input(100000, 0.25f * LSB_16);
+  FloatToPcmConverter dithered{{.seed = 7u}};
+  FloatToPcmConverter sameSeed{{.seed = 7u}};
+  FloatToPcmConverter undithered{{.dither = false}};
+
+  // when
+  const auto output = convert(dithered, input);
+
+  // then
+  auto sum = 0.0;
+  for (const auto sample : output) {
+    EXPECT_LE(std::abs(sample), 1);
+    sum += sample;
+  }
+  EXPECT_NEAR(0.25, sum / std::ssize(output), 0.01);
+  EXPECT_EQ(output, convert(sameSeed, input));
+  EXPECT_EQ(std::vector<std::int32_t>(input.size(), 0),
+            convert(undithered, input));
+}
+
+TEST(FloatToPcmConverter, NoiseShapingRemovesTheDcOfTheError) {
+  using namespace std::chrono_literals;
+
+  // given
+  auto input = generateSine(997_Hz, 48000_Hz, 1s);
+  for (auto& sample : input) {
+    sample *= 0.5f;
+  }
+
+  for (const auto noiseShaping :
+       {FloatToPcmConverter::NoiseShaping::FIRST_ORDER,
+        FloatToPcmConverter::NoiseShaping::SECOND_ORDER}) {
+    FloatToPcmConverter converter{{.noiseShaping = noiseShaping}};
+
+    // when
+    const auto output = convert(converter, input);
+
+    // then the shaped error telescopes, so its sum stays bounded
+    auto errorSum = 0.0;
+    for (auto i = 0u; i < output.size(); ++i) {
+      errorSum += output[i] - static_cast<double>(input[i]) * 32768.0;
+    }
+    EXPECT_LT(std::abs(errorSum), 8.0);
+  }
+}
+}  // namespace wolfsound
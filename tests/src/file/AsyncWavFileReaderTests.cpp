@@ -0,0 +1,202 @@
+#include <gtest/gtest.h>
+#include <wolfsound/file/wolfsound_AsyncWavFileReader.hpp>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+namespace wolfsound {
+namespace {
+juce::File testFile() {
+  return juce::File::getSpecialLocation(
+             juce::File::SpecialLocationType::currentExecutableFile)
+      .getParentDirectory()
+      .getChildFile("asyncReaderTest.wav");
+}
+
+void appendLittleEndian(std::vector<char>& bytes,
+                        std::uint32_t value,
+                        int numBytes) {
+  for (auto i = 0; i < numBytes; ++i) {
+    bytes.push_back(static_cast<char>((value >> (8 * i)) & 0xFFu));
+  }
+}
+
+/** Writes a 24-bit stereo file whose left channel counts up from 0 and
+ * whose right channel counts down from -1, preceded by an unknown chunk. */
+void writeRampFile(const juce::File& file, std::uint32_t numFrames) {
+  std::vector<char> bytes{'R', 'I', 'F', 'F', 0, 0, 0, 0, 'W', 'A', 'V', 'E'};
+  bytes.insert(bytes.end(), {'L', 'I', 'S', 'T', 3, 0, 0, 0, 'a', 'b', 'c', 0});
+  bytes.insert(bytes.end(), {'f', 'm', 't', ' '});
+  appendLittleEndian(bytes, 16u, 4);
+  appendLittleEndian(bytes, 1u, 2);
+  appendLittleEndian(bytes, 2u, 2);
+  appendLittleEndian(bytes, 48000u, 4);
+  appendLittleEndian(bytes, 48000u * 6u, 4);
+  appendLittleEndian(bytes, 6u, 2);
+  appendLittleEndian(bytes, 24u, 2);
+  bytes.insert(bytes.end(), {'d', 'a', 't', 'a'});
+  appendLittleEndian(bytes, numFrames * 6u, 4);
+  for (auto frame = 0u; frame < numFrames; ++frame) {
+    appendLittleEndian(bytes, frame, 3);
+    appendLittleEndian(bytes, static_cast<std::uint32_t>(-1 - int(frame)), 3);
+  }
+
+  std::ofstream{file.getFullPathName().toStdString(), std::ios::binary}.write(
+      bytes.data(), static_cast<std::streamsize>(bytes.size()));
+}
+}  // namespace
+
+TEST(AsyncWavFileReader, DecodesWithBothBackends) {
+  // given
+  constexpr auto NUM_FRAMES = 10007u;
+  writeRampFile(testFile(), NUM_FRAMES);
+
+  for (const auto useIoUring : {true, false}) {
+    // chunk size deliberately not a multiple of the frame size
+    AsyncWavFileReader reader{{.chunkSizeInBytes = 1000u,
+                               .queueDepth = 8u,
+                               .numThreads = 3u,
+                               .useIoUring = useIoUring}};
+
+    // when
+    const auto decoded = reader.decode(testFile());
+
+    // then
+    EXPECT_EQ(48000.0, decoded->sampleRate);
+    ASSERT_EQ(2, decoded->samples.getNumChannels());
+    ASSERT_EQ(int(NUM_FRAMES), decoded->samples.getNumSamples());
+    for (auto i = 0; i < int(NUM_FRAMES); ++i) {
+      ASSERT_EQ(float(i) / 8388608.f, decoded->samples.getSample(0, i));
+      ASSERT_EQ(float(-1 - i) / 8388608.f, decoded->samples.getSample(1, i));
+    }
+  }
+
+  // cleanup
+  testFile().deleteFile();
+}
+
+TEST(AsyncWavFileReader, PipelineMayDecodeOnAnotherThread) {
+  // given
+  constexpr auto NUM_FRAMES = 5000u;
+  writeRampFile(testFile(), NUM_FRAMES);
+  AsyncWavFileReader reader{
+      {.chunkSizeInBytes = 600u, .maxChunksInPipeline = 2u}};
+
+  std::mutex mutex;
+  std::condition_variable chunkQueued;
+  std::deque<std::optional<WavDataChunk>> queue;
+  std::vector<float> left(NUM_FRAMES), right(NUM_FRAMES);
+
+  std::jthread decoder{[&] {
+    while (true) {
+      std::unique_lock lock{mutex};
+      chunkQueued.wait(lock, [&] { return !queue.empty(); });
+      auto chunk = std::move(queue.front());
+      queue.pop_front();
+      lock.unlock();
+
+      if (!chunk) {
+        return;
+      }
+      const auto start = static_cast<std::size_t>(chunk->getStartSample());
+      float* destinations[] = {left.data() + start, right.data() + start};
+      chunk->decodeTo(destinations);
+    }
+  }};
+
+  // when
+  reader.read(testFile(), [&](WavDataChunk chunk) {
+    const std::scoped_lock lock{mutex};
+    queue.emplace_back(std::move(chunk));
+    chunkQueued.notify_one();
+  });
+  {
+    const std::scoped_lock lock{mutex};
+    queue.emplace_back(std::nullopt);
+    chunkQueued.notify_one();
+  }
+  decoder.join();
+
+  // then
+  for (auto i = 0u; i < NUM_FRAMES; ++i) {
+    ASSERT_EQ(float(i) / 8388608.f, left[i]);
+  }
+
+  // cleanup
+  testFile().deleteFile();
+}
+
+TEST(AsyncWavFileReader, RethrowsPipelineExceptions) {
+  // given
+  writeRampFile(testFile(), 1000u);
+
+  for (const auto useIoUring : {true, false}) {
+    AsyncWavFileReader reader{
+        {.chunkSizeInBytes = 60u, .useIoUring = useIoUring}};
+
+    // when, then
+    EXPECT_THROW(reader.read(testFile(),
+                             [](WavDataChunk chunk) {
+                               if (chunk.getStartSample() == 50) {
+                                 throw std::runtime_error{"decode failed"};
+                               }
+                             }),
+                 std::runtime_error);
+  }
+
+  // cleanup
+  testFile().deleteFile();
+}
+
+TEST(AsyncWavFileReader, RejectsFilesTooLongToDecodeIntoMemory) {
+  // given an 8-bit mono file of more than INT_MAX frames; sparse, so that
+  // it takes no space on disk
+  constexpr auto NUM_FRAMES = 0x90000000u;
+  std::vector<char> header{'R', 'I', 'F', 'F', 0, 0, 0, 0, 'W', 'A', 'V', 'E'};
+  header.insert(header.end(), {'f', 'm', 't', ' '});
+  appendLittleEndian(header, 16u, 4);
+  appendLittleEndian(header, 1u, 2);
+  appendLittleEndian(header, 1u, 2);
+  appendLittleEndian(header, 48000u, 4);
+  appendLittleEndian(header, 48000u, 4);
+  appendLittleEndian(header, 1u, 2);
+  appendLittleEndian(header, 8u, 2);
+  header.insert(header.end(), {'d', 'a', 't', 'a'});
+  appendLittleEndian(header, NUM_FRAMES, 4);
+  const auto path = testFile().getFullPathName().toStdString();
+  std::ofstream{path, std::ios::binary}.write(
+      header.data(), static_cast<std::streamsize>(header.size()));
+  std::filesystem::resize_file(path, header.size() + NUM_FRAMES);
+  AsyncWavFileReader reader;
+
+  // when, then
+  EXPECT_THROW((void)reader.decode(testFile()), std::runtime_error);
+
+  // cleanup
+  testFile().deleteFile();
+}
+
+TEST(WavDataLayout, DecodesSupportedEncodings) {
+  const auto decodeOne = [](int bitsPerSample, bool isFloatingPoint,
+                            std::vector<std::uint8_t> bytes) {
+    const WavDataLayout layout{.numChannels = 1,
+                               .bitsPerSample = bitsPerSample,
+                               .isFloatingPoint = isFloatingPoint};
+    auto sample = 0.f;
+    float* destination = &sample;
+    layout.decode(std::as_bytes(std::span{bytes}), &destination);
+    return sample;
+  };
+
+  EXPECT_EQ(-1.f, decodeOne(8, false, {0x00}));
+  EXPECT_EQ(0.5f, decodeOne(16, false, {0x00, 0x40}));
+  EXPECT_EQ(-0.5f, decodeOne(24, false, {0x00, 0x00, 0xC0}));
+  EXPECT_EQ(-1.f, decodeOne(32, false, {0x00, 0x00, 0x00, 0x80}));
+  EXPECT_EQ(0.25f, decodeOne(32, true, {0x00, 0x00, 0x80, 0x3E}));
+}
+}  // namespace wolfsound
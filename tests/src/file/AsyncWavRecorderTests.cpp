@@ -0,0 +1,99 @@
+#include <gtest/gtest.h>
+#include <wolfsound/file/wolfsound_AsyncWavRecorder.hpp>
+#include <wolfsound/file/wolfsound_WavFileReader.hpp>
+#include "wolfsound/dsp/wolfsound_testSignals.hpp"
+#include <chrono>
+
+namespace wolfsound {
+namespace {
+juce::File testFile() {
+  return juce::File::getSpecialLocation(
+             juce::File::SpecialLocationType::currentExecutableFile)
+      .getParentDirectory()
+      .getChildFile("asyncRecorderTest.wav");
+}
+}  // namespace
+
+TEST(AsyncWavRecorder, PushedBlocksAreWrittenInOrder) {
+  using namespace std::chrono_literals;
+
+  // given
+  constexpr auto SAMPLE_RATE = 48000_Hz;
+  constexpr auto BLOCK_SIZE = 64;
+  const auto left = generateWhiteNoise(SAMPLE_RATE, 1s, 0u);
+  const auto right = generateWhiteNoise(SAMPLE_RATE, 1s, 1u);
+  AsyncWavRecorder recorder{
+      {.writer = {.absolutePath = testFile().getFullPathName().toStdString(),
+                  .sampleRate = SAMPLE_RATE,
+                  .numChannels = 2},
+       .fifoSizeInSamples = 1 << 16,
+       .drainInterval = 1ms}};
+
+  // when
+  for (auto start = 0; start < std::ssize(left); start += BLOCK_SIZE) {
+    const float* channels[] = {left.data() + start, right.data() + start};
+    ASSERT_TRUE(recorder.push(
+        channels, std::min(BLOCK_SIZE, static_cast<int>(left.size()) - start)));
+  }
+  recorder.stop();
+
+  // then
+  const auto statistics = recorder.getStatistics();
+  EXPECT_EQ(0u, statistics.overruns);
+  EXPECT_EQ(0, statistics.queueDepth);
+  EXPECT_EQ(left.size(), statistics.samplesWritten);
+  EXPECT_GE(statistics.maxQueueDepth, BLOCK_SIZE);
+
+  WavFileReader reader;
+  reader.loadFile(testFile());
+  ASSERT_EQ(2, reader.getNumChannels());
+  ASSERT_EQ(left.size(), reader.getLengthInSamples());
+  for (const auto i : std::views::iota(0u, reader.getLengthInSamples())) {
+    constexpr auto TOLERANCE = 1e-4f;
+    EXPECT_NEAR(left[i], reader.getSamples().getSample(0, int(i)), TOLERANCE);
+    EXPECT_NEAR(right[i], reader.getSamples().getSample(1, int(i)), TOLERANCE);
+  }
+
+  // cleanup
+  testFile().deleteFile();
+}
+
+TEST(AsyncWavRecorder, BlocksThatDoNotFitAreDroppedAndCounted) {
+  using namespace std::chrono_literals;
+
+  // given
+  constexpr auto BLOCK_SIZE = 100;
+  const auto block = generateSine(440_Hz, 48000_Hz, 10ms);
+  const float* channels[] = {block.data()};
+  // the writer thread does not drain during the test
+  AsyncWavRecorder recorder{
+      {.writer = {.absolutePath = testFile().getFullPathName().toStdString(),
+                  .sampleRate = 48000_Hz},
+       .fifoSizeInSamples = 2 * BLOCK_SIZE + 1,
+       .drainInterval = 1h}};
+
+  // when
+  EXPECT_TRUE(recorder.push(channels, BLOCK_SIZE));
+  EXPECT_TRUE(recorder.push(channels, BLOCK_SIZE));
+  EXPECT_FALSE(recorder.push(channels, BLOCK_SIZE));
+  EXPECT_FALSE(recorder.push(channels, BLOCK_SIZE / 2));
+
+  // then
+  auto statistics = recorder.getStatistics();
+  EXPECT_EQ(2u, statistics.overruns);
+  EXPECT_EQ(3u * BLOCK_SIZE / 2u, statistics.droppedSamples);
+  EXPECT_EQ(2 * BLOCK_SIZE, statistics.queueDepth);
+  EXPECT_EQ(2 * BLOCK_SIZE, statistics.maxQueueDepth);
+
+  // when
+  recorder.stop();
+
+  // then
+  statistics = recorder.getStatistics();
+  EXPECT_EQ(0, statistics.queueDepth);
+  EXPECT_EQ(2u * BLOCK_SIZE, statistics.samplesWritten);
+
+  // cleanup
+  testFile().deleteFile();
+}
+}  // namespace wolfsound
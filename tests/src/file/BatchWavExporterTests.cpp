@@ -0,0 +1,99 @@
+#include <gtest/gtest.h>
+#include <wolfsound/file/wolfsound_BatchWavExporter.hpp>
+#include <wolfsound/file/wolfsound_WavFileReader.hpp>
+#include "wolfsound/dsp/wolfsound_testSignals.hpp"
+#include <chrono>
+#include <vector>
+
+namespace wolfsound {
+namespace {
+juce::File testDirectory() {
+  return juce::File::getSpecialLocation(
+             juce::File::SpecialLocationType::currentExecutableFile)
+      .getParentDirectory()
+      .getChildFile("batchExport");
+}
+
+juce::AudioBuffer<float> noise(int numChannels, unsigned seed) {
+  using namespace std::chrono_literals;
+
+  const auto samples = generateWhiteNoise(48000_Hz, 100ms, seed);
+  juce::AudioBuffer<float> buffer{numChannels,
+                                  static_cast<int>(samples.size())};
+  for (auto channel = 0; channel < numChannels; ++channel) {
+    buffer.copyFrom(channel, 0, samples.data(), buffer.getNumSamples());
+  }
+  return buffer;
+}
+}  // namespace
+
+TEST(BatchWavExporter, WritesEveryJob) {
+  // given
+  std::vector<WavExportJob> jobs;
+  for (auto i = 0; i < 20; ++i) {
+    const auto directory =
+        testDirectory().getChildFile("subdirectory" + juce::String{i % 3});
+    jobs.push_back(
+        {.absolutePath =
+             directory.getChildFile("output" + juce::String{i})
+                 .getFullPathName()
+                 .toStdString(),
+         .samples = noise(1 + i % 2, static_cast<unsigned>(i)),
+         .sampleRate = 48000_Hz});
+  }
+
+  // when
+  const auto results = BatchWavExporter{{.numThreads = 4}}.exportAll(jobs);
+
+  // then
+  ASSERT_EQ(jobs.size(), results.size());
+  for (auto i = 0u; i < jobs.size(); ++i) {
+    ASSERT_TRUE(results[i].succeeded) << results[i].errorMessage;
+    EXPECT_EQ(".wav", results[i].file.getFileExtension());
+
+    WavFileReader reader;
+    reader.loadFile(results[i].file);
+    EXPECT_EQ(jobs[i].samples.getNumChannels(), reader.getNumChannels());
+    EXPECT_EQ(jobs[i].samples.getNumSamples(),
+              static_cast<int>(reader.getLengthInSamples()));
+  }
+
+  // cleanup
+  testDirectory().deleteRecursively();
+}
+
+TEST(BatchWavExporter, ReportsFailuresWithoutAbortingTheBatch) {
+  // given a directory that cannot be created because a file has its name
+  const auto blockingFile = testDirectory().getChildFile("notADirectory");
+  ASSERT_TRUE(blockingFile.create().wasOk());
+  const std::vector<WavExportJob> jobs{
+      {.absolutePath =
+           testDirectory().getChildFile("first.wav").getFullPathName()
+               .toStdString(),
+       .samples = noise(1, 0u),
+       .sampleRate = 48000_Hz},
+      {.absolutePath =
+           blockingFile.getChildFile("second.wav").getFullPathName()
+               .toStdString(),
+       .samples = noise(1, 1u),
+       .sampleRate = 48000_Hz},
+      {.absolutePath =
+           testDirectory().getChildFile("third.wav").getFullPathName()
+               .toStdString(),
+       .samples = noise(2, 2u),
+       .sampleRate = 48000_Hz}};
+
+  // when
+  const auto results = BatchWavExporter{}.exportAll(jobs);
+
+  // then
+  EXPECT_TRUE(results[0].succeeded);
+  EXPECT_FALSE(results[1].succeeded);
+  EXPECT_FALSE(results[1].errorMessage.empty());
+  EXPECT_TRUE(results[2].succeeded);
+  EXPECT_TRUE(results[2].file.existsAsFile());
+
+  // cleanup
+  testDirectory().deleteRecursively();
+}
+}  // namespace wolfsound
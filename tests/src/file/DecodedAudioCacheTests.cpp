@@ -0,0 +1,131 @@
+#include <gtest/gtest.h>
+#include <wolfsound/file/wolfsound_DecodedAudioCache.hpp>
+#include <wolfsound/file/wolfsound_WavFileReader.hpp>
+#include <wolfsound/file/wolfsound_WavFileWriter.hpp>
+#include "wolfsound/dsp/wolfsound_testSignals.hpp"
+#include <chrono>
+#include <stdexcept>
+#include <tuple>
+
+namespace wolfsound {
+namespace {
+std::shared_ptr<const DecodedAudio> makeDecodedAudio(int numSamples) {
+  auto decoded = std::make_shared<DecodedAudio>();
+  decoded->samples.setSize(1, numSamples);
+  decoded->samples.clear();
+  decoded->sampleRate = 48000.0;
+  return decoded;
+}
+
+DecodedAudioCache::Key makeKey(const std::string& path) {
+  return {.path = path};
+}
+}  // namespace
+
+TEST(DecodedAudioCache, CountsHitsAndMisses) {
+  DecodedAudioCache cache{1024u * sizeof(float)};
+  auto loadCount = 0;
+  const auto load = [&] {
+    ++loadCount;
+    return makeDecodedAudio(16);
+  };
+
+  const auto first = cache.getOrLoad(makeKey("a.wav"), load);
+  const auto second = cache.getOrLoad(makeKey("a.wav"), load);
+
+  EXPECT_EQ(1, loadCount);
+  EXPECT_EQ(first, second);
+  const auto statistics = cache.getStatistics();
+  EXPECT_EQ(1u, statistics.hits);
+  EXPECT_EQ(1u, statistics.misses);
+  EXPECT_EQ(1u, statistics.entries);
+  EXPECT_EQ(16u * sizeof(float), statistics.sizeInBytes);
+}
+
+TEST(DecodedAudioCache, EvictsLeastRecentlyUsedEntriesWhenOverBudget) {
+  DecodedAudioCache cache{2u * 16u * sizeof(float)};
+  const auto load = [] { return makeDecodedAudio(16); };
+
+  const auto a = cache.getOrLoad(makeKey("a.wav"), load);
+  std::ignore = cache.getOrLoad(makeKey("b.wav"), load);
+  // touch "a" so that "b" becomes the least recently used entry
+  std::ignore = cache.getOrLoad(makeKey("a.wav"), load);
+  std::ignore = cache.getOrLoad(makeKey("c.wav"), load);
+
+  EXPECT_NE(nullptr, cache.find(makeKey("a.wav")));
+  EXPECT_EQ(nullptr, cache.find(makeKey("b.wav")));
+  EXPECT_NE(nullptr, cache.find(makeKey("c.wav")));
+  EXPECT_EQ(1u, cache.getStatistics().evictions);
+
+  // evicted or not, handed-out buffers stay valid
+  cache.clear();
+  EXPECT_EQ(16, a->samples.getNumSamples());
+}
+
+TEST(DecodedAudioCache, DoesNotCacheEntriesLargerThanBudget) {
+  DecodedAudioCache cache{8u * sizeof(float)};
+
+  const auto decoded =
+      cache.getOrLoad(makeKey("a.wav"), [] { return makeDecodedAudio(16); });
+
+  EXPECT_NE(nullptr, decoded);
+  EXPECT_EQ(nullptr, cache.find(makeKey("a.wav")));
+  EXPECT_EQ(0u, cache.getStatistics().sizeInBytes);
+}
+
+TEST(DecodedAudioCache, DistinguishesModificationTimes) {
+  DecodedAudioCache cache{1024u * sizeof(float)};
+  const auto load = [] { return makeDecodedAudio(16); };
+
+  std::ignore = cache.getOrLoad({.path = "a.wav", .lastModificationTime = 1},
+                                load);
+  std::ignore = cache.getOrLoad({.path = "a.wav", .lastModificationTime = 2},
+                                load);
+
+  EXPECT_EQ(2u, cache.getStatistics().misses);
+}
+
+TEST(DecodedAudioCache, PropagatesLoaderExceptionsWithoutCaching) {
+  DecodedAudioCache cache{1024u * sizeof(float)};
+
+  EXPECT_THROW(std::ignore = cache.getOrLoad(
+                   makeKey("a.wav"),
+                   []() -> std::shared_ptr<const DecodedAudio> {
+                     throw std::runtime_error{"decoding failed"};
+                   }),
+               std::runtime_error);
+  EXPECT_EQ(nullptr, cache.find(makeKey("a.wav")));
+}
+
+TEST(DecodedAudioCache, ReadersShareDecodedBuffer) {
+  using namespace std::chrono_literals;
+
+  // given
+  constexpr auto SAMPLE_RATE = 48000_Hz;
+  constexpr auto SEED = 0u;
+  const auto testFile =
+      juce::File::getSpecialLocation(
+          juce::File::SpecialLocationType::currentExecutableFile)
+          .getParentDirectory()
+          .getChildFile("cachedNoise.wav");
+  WavFileWriter::writeToFile(testFile.getFullPathName().toStdString(),
+                             generateWhiteNoise(SAMPLE_RATE, 1s, SEED),
+                             SAMPLE_RATE);
+  auto cache = std::make_shared<DecodedAudioCache>(16u << 20u);
+
+  // when
+  WavFileReader reader{{.cache = cache}};
+  reader.loadFile(testFile);
+  WavFileReader otherReader{{.cache = cache}};
+  otherReader.loadFile(testFile);
+
+  // then
+  EXPECT_EQ(&reader.getSamples(), &otherReader.getSamples());
+  EXPECT_EQ(SAMPLE_RATE, otherReader.getSampleRate());
+  EXPECT_EQ(1u, cache->getStatistics().hits);
+  EXPECT_EQ(1u, cache->getStatistics().misses);
+
+  // cleanup
+  testFile.deleteFile();
+}
+}  // namespace wolfsound
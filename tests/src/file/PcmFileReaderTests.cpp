@@ -0,0 +1,92 @@
+#include <gtest/gtest.h>
+#include <wolfsound/file/wolfsound_PcmFileReader.hpp>
+#include <wolfsound/file/wolfsound_WavFileReader.hpp>
+#include <wolfsound/file/wolfsound_WavFileWriter.hpp>
+#include "wolfsound/dsp/wolfsound_testSignals.hpp"
+#include <chrono>
+
+namespace wolfsound {
+TEST(PcmFileReader, Reads16BitFileInNativeWidth) {
+  using namespace std::chrono_literals;
+
+  // given
+  constexpr auto SAMPLE_RATE = 48000_Hz;
+  constexpr auto SEED = 0u;
+  const auto testFile =
+      juce::File::getSpecialLocation(
+          juce::File::SpecialLocationType::currentExecutableFile)
+          .getParentDirectory()
+          .getChildFile("pcmNoise.wav");
+  WavFileWriter::writeToFile(testFile.getFullPathName().toStdString(),
+                             generateWhiteNoise(SAMPLE_RATE, 1s, SEED),
+                             SAMPLE_RATE);
+  WavFileReader floatReader;
+  floatReader.loadFile(testFile);
+
+  // when
+  PcmFileReader reader;
+  EXPECT_TRUE(reader.loadFile(testFile));
+
+  // then
+  EXPECT_EQ(SampleFormat::INT16, reader.getSampleFormat());
+  EXPECT_EQ(16, reader.getBitsPerSample());
+  EXPECT_EQ(SAMPLE_RATE, reader.getSampleRate());
+  ASSERT_EQ(floatReader.getLengthInSamples(), reader.getLengthInSamples());
+  const auto& samples = reader.getSamples<std::int16_t>();
+  for (const auto i : std::views::iota(0u, reader.getLengthInSamples())) {
+    EXPECT_FLOAT_EQ(floatReader.getSamples().getSample(0, int(i)) * 32768.f,
+                    static_cast<float>(samples.getChannel(0)[i]));
+  }
+
+  // cleanup
+  testFile.deleteFile();
+}
+
+TEST(PcmFileReader, ConvertsToFloatLikeFloatReader) {
+  using namespace std::chrono_literals;
+
+  // given
+  constexpr auto SAMPLE_RATE = 44100_Hz;
+  const auto testFile =
+      juce::File::getSpecialLocation(
+          juce::File::SpecialLocationType::currentExecutableFile)
+          .getParentDirectory()
+          .getChildFile("pcmSine.wav");
+  WavFileWriter::writeToFile(testFile.getFullPathName().toStdString(),
+                             generateSine(440_Hz, SAMPLE_RATE, 1s),
+                             SAMPLE_RATE);
+  WavFileReader floatReader;
+  floatReader.loadFile(testFile);
+  PcmFileReader reader;
+  reader.loadFile(testFile);
+
+  // when
+  juce::AudioBuffer<float> converted;
+  convertToFloat(reader.getSamples<std::int16_t>(), converted);
+
+  // then
+  ASSERT_EQ(floatReader.getSamples().getNumSamples(),
+            converted.getNumSamples());
+  for (const auto i : std::views::iota(0, converted.getNumSamples())) {
+    EXPECT_FLOAT_EQ(floatReader.getSamples().getSample(0, i),
+                    converted.getSample(0, i));
+  }
+
+  // cleanup
+  testFile.deleteFile();
+}
+
+TEST(PcmBuffer, ConvertsInt24InInt32ToFloat) {
+  PcmBuffer<std::int32_t> buffer{1, 3u, 24};
+  buffer.getWritePointer(0)[0] = -(1 << 23);
+  buffer.getWritePointer(0)[1] = 0;
+  buffer.getWritePointer(0)[2] = 1 << 22;
+
+  juce::AudioBuffer<float> converted;
+  convertToFloat(buffer, converted);
+
+  EXPECT_FLOAT_EQ(-1.f, converted.getSample(0, 0));
+  EXPECT_FLOAT_EQ(0.f, converted.getSample(0, 1));
+  EXPECT_FLOAT_EQ(0.5f, converted.getSample(0, 2));
+}
+}  // namespace wolfsound
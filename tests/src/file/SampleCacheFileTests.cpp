@@ -0,0 +1,84 @@
+#include <gtest/gtest.h>
+#include <wolfsound/file/wolfsound_SampleCacheFile.hpp>
+#include <wolfsound/file/wolfsound_WavFileReader.hpp>
+#include <wolfsound/file/wolfsound_WavFileWriter.hpp>
+#include "wolfsound/dsp/wolfsound_testSignals.hpp"
+#include <chrono>
+
+namespace wolfsound {
+namespace {
+juce::File testDirectory() {
+  return juce::File::getSpecialLocation(
+             juce::File::SpecialLocationType::currentExecutableFile)
+      .getParentDirectory()
+      .getChildFile("sampleCacheFileTests");
+}
+}  // namespace
+
+TEST(SampleCacheFile, ReaderCreatesAndReusesSidecar) {
+  using namespace std::chrono_literals;
+
+  // given
+  constexpr auto SAMPLE_RATE = 48000_Hz;
+  constexpr auto SEED = 0u;
+  const auto testSignal = generateWhiteNoise(SAMPLE_RATE, 1s, SEED);
+  const auto testFile = testDirectory().getChildFile("noise.wav");
+  WavFileWriter::writeToFile(testFile.getFullPathName().toStdString(),
+                             testSignal, SAMPLE_RATE);
+  const auto cacheFile =
+      testFile.getSiblingFile("noise.wav" +
+                              juce::String{SampleCacheFile::FILE_EXTENSION});
+
+  // when
+  WavFileReader decodingReader{{.useSampleCacheFiles = true}};
+  decodingReader.loadFile(testFile);
+  WavFileReader mappingReader{{.useSampleCacheFiles = true}};
+  mappingReader.loadFile(testFile);
+
+  // then
+  EXPECT_TRUE(cacheFile.existsAsFile());
+  EXPECT_EQ(SAMPLE_RATE, mappingReader.getSampleRate());
+  ASSERT_EQ(testSignal.size(), mappingReader.getLengthInSamples());
+  for (const auto i : std::views::iota(0u, testSignal.size())) {
+    EXPECT_FLOAT_EQ(decodingReader.getSamples().getSample(0, int(i)),
+                    mappingReader.getSamples().getSample(0, int(i)));
+  }
+
+  // cleanup
+  testDirectory().deleteRecursively();
+}
+
+TEST(SampleCacheFile, IsInvalidatedByContentButNotByTimestamp) {
+  using namespace std::chrono_literals;
+
+  // given
+  constexpr auto SAMPLE_RATE = 48000_Hz;
+  const auto testFile = testDirectory().getChildFile("noise.wav");
+  const auto cacheFile = testDirectory().getChildFile("noise.wssc");
+  WavFileWriter::writeToFile(testFile.getFullPathName().toStdString(),
+                             generateWhiteNoise(SAMPLE_RATE, 1s, 0u),
+                             SAMPLE_RATE);
+  WavFileReader reader;
+  reader.loadFile(testFile);
+  SampleCacheFile::write(cacheFile, testFile,
+                         {.samples = reader.getSamples(),
+                          .sampleRate = reader.getSampleRate().value()});
+
+  // when
+  testFile.setLastModificationTime(juce::Time{0});
+
+  // then
+  EXPECT_NE(nullptr, SampleCacheFile::load(cacheFile, testFile));
+
+  // when
+  WavFileWriter::writeToFile(testFile.getFullPathName().toStdString(),
+                             generateWhiteNoise(SAMPLE_RATE, 1s, 2u),
+                             SAMPLE_RATE);
+
+  // then
+  EXPECT_EQ(nullptr, SampleCacheFile::load(cacheFile, testFile));
+
+  // cleanup
+  testDirectory().deleteRecursively();
+}
+}  // namespace wolfsound
@@ -0,0 +1,220 @@
+#include <gtest/gtest.h>
+#include <wolfsound/file/wolfsound_StreamingWavFileWriter.hpp>
+#include <wolfsound/file/wolfsound_WavFileReader.hpp>
+#include "wolfsound/dsp/wolfsound_testSignals.hpp"
+#include "largeFileFormat.hpp"
+#include <wolfsound/file/wolfsound_WavDataLayout.hpp>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace wolfsound {
+namespace {
+juce::File testFile() {
+  return juce::File::getSpecialLocation(
+             juce::File::SpecialLocationType::currentExecutableFile)
+      .getParentDirectory()
+      .getChildFile("streamingWriterTest.wav");
+}
+}  // namespace
+
+TEST(StreamingWavFileWriter, AppendedBlocksAreReadBackAsOneSignal) {
+  using namespace std::chrono_literals;
+
+  // given
+  constexpr auto SAMPLE_RATE = 48000_Hz;
+  constexpr auto BLOCK_SIZE = 100u;
+  const auto testSignal = generateWhiteNoise(SAMPLE_RATE, 1s, 0u);
+
+  // when
+  {
+    StreamingWavFileWriter writer{
+        {.absolutePath = testFile().getFullPathName().toStdString(),
+         .sampleRate = SAMPLE_RATE}};
+    for (auto start = 0u; start < testSignal.size(); start += BLOCK_SIZE) {
+      writer.append(juce::Span{testSignal.data() + start,
+                               std::min<std::size_t>(
+                                   BLOCK_SIZE, testSignal.size() - start)});
+    }
+    EXPECT_EQ(std::ssize(testSignal), writer.getNumSamplesWritten());
+  }  // the destructor finalizes the header
+
+  // then
+  WavFileReader reader;
+  reader.loadFile(testFile());
+  ASSERT_EQ(testSignal.size(), reader.getLengthInSamples());
+  for (const auto i : std::views::iota(0u, reader.getLengthInSamples())) {
+    constexpr auto TOLERANCE = 1e-4f;
+    EXPECT_NEAR(testSignal[i], reader.getSamples().getSample(0, int(i)),
+                TOLERANCE);
+  }
+
+  // cleanup
+  testFile().deleteFile();
+}
+
+TEST(StreamingWavFileWriter, FlushedFileIsReadableWhileOpen) {
+  using namespace std::chrono_literals;
+
+  // given
+  constexpr auto SAMPLE_RATE = 44100_Hz;
+  const auto firstBlock = generateSine(440_Hz, SAMPLE_RATE, 100ms);
+  StreamingWavFileWriter writer{
+      {.absolutePath = testFile().getFullPathName().toStdString(),
+       .sampleRate = SAMPLE_RATE,
+       .numChannels = 2}};
+  const float* channels[] = {firstBlock.data(), firstBlock.data()};
+
+  // when
+  writer.append(channels, static_cast<int>(firstBlock.size()));
+  writer.flush();
+
+  // then
+  WavFileReader reader;
+  reader.loadFile(testFile());
+  EXPECT_EQ(2, reader.getNumChannels());
+  EXPECT_EQ(firstBlock.size(), reader.getLengthInSamples());
+
+  // cleanup
+  writer.close();
+  EXPECT_FALSE(writer.isOpen());
+  testFile().deleteFile();
+}
+
+TEST(StreamingWavFileWriter, SamplesAreRoundedToNearestByDefault) {
+  // given
+  constexpr auto LSB = 1.f / 32768.f;
+  const std::vector<float> samples{0.4f * LSB, 0.6f * LSB, -0.6f * LSB,
+                                   1000.4f * LSB, 2.f};
+
+  // when
+  {
+    StreamingWavFileWriter writer{
+        {.absolutePath = testFile().getFullPathName().toStdString(),
+         .sampleRate = 48000_Hz}};
+    writer.append(juce::Span{samples});
+  }
+
+  // then
+  WavFileReader reader;
+  reader.loadFile(testFile());
+  ASSERT_EQ(samples.size(), reader.getLengthInSamples());
+  const std::vector<float> expected{0.f, LSB, -LSB, 1000.f * LSB,
+                                    32767.f * LSB};
+  for (auto i = 0u; i < expected.size(); ++i) {
+    EXPECT_EQ(expected[i], reader.getSamples().getSample(0, int(i)));
+  }
+
+  // cleanup
+  testFile().deleteFile();
+}
+
+TEST(StreamingWavFileWriter, CreatesTheDirectoryOnlyIfAskedTo) {
+  // given
+  const auto directory =
+      testFile().getParentDirectory().getChildFile("streamingWriterDirectory");
+  const auto path =
+      directory.getChildFile("test.wav").getFullPathName().toStdString();
+  directory.deleteRecursively();
+
+  // when, then
+  EXPECT_THROW(StreamingWavFileWriter({.absolutePath = path,
+                                       .sampleRate = 48000_Hz,
+                                       .createDirectory = false}),
+               std::runtime_error);
+  EXPECT_FALSE(directory.exists());
+  StreamingWavFileWriter{{.absolutePath = path, .sampleRate = 48000_Hz}};
+  EXPECT_TRUE(directory.getChildFile("test.wav").existsAsFile());
+
+  // cleanup
+  directory.deleteRecursively();
+}
+
+TEST(StreamingWavFileWriter, MarkingAsBw64ChangesOnlyTheIdOfRf64Files) {
+  // given
+  const std::vector<std::int16_t> samples{0, 16384, -16384, -32768};
+  const auto rf64 = largeFileFormat("RF64", samples);
+  ASSERT_TRUE(testFile().replaceWithData(rf64.getData(), rf64.getSize()));
+
+  // when
+  detail::markRf64AsBw64(testFile());
+
+  // then
+  juce::MemoryBlock written;
+  ASSERT_TRUE(testFile().loadFileAsData(written));
+  const auto bw64 = largeFileFormat("BW64", samples);
+  EXPECT_EQ(bw64, written);
+  WavFileReader reader;
+  reader.loadFile(testFile());
+  ASSERT_EQ(samples.size(), reader.getLengthInSamples());
+  for (auto i = 0u; i < samples.size(); ++i) {
+    EXPECT_EQ(samples[i] / 32768.f, reader.getSamples().getSample(0, int(i)));
+  }
+
+  // cleanup
+  testFile().deleteFile();
+}
+
+TEST(StreamingWavFileWriter, FilesUnder4GbStayRiffWhenBw64IsChosen) {
+  // given
+  const std::vector<float> samples(100u, 0.5f);
+
+  // when
+  {
+    StreamingWavFileWriter writer{
+        {.absolutePath = testFile().getFullPathName().toStdString(),
+         .sampleRate = 48000_Hz,
+         .largeFileFormat = WavLargeFileFormat::BW64}};
+    writer.append(juce::Span{samples});
+  }
+
+  // then
+  juce::FileInputStream stream{testFile()};
+  char id[4]{};
+  ASSERT_EQ(4, stream.read(id, 4));
+  EXPECT_EQ("RIFF", std::string(id, 4u));
+
+  // cleanup
+  testFile().deleteFile();
+}
+
+// Writes over 4 GB; run with --gtest_also_run_disabled_tests.
+TEST(StreamingWavFileWriter, DISABLED_WritesFilesOver4GbAsRf64OrBw64) {
+  // given
+  constexpr auto BLOCK_SIZE = 1 << 20;
+  // 16-bit stereo: 4 bytes per frame, so 2^30 frames fill 4 GB
+  constexpr auto NUM_BLOCKS = (1 << 10) + 1;
+  const std::vector<float> block(BLOCK_SIZE, 0.25f);
+  const float* channels[] = {block.data(), block.data()};
+
+  for (const auto [format, id] :
+       {std::pair{WavLargeFileFormat::RF64, "RF64"},
+        std::pair{WavLargeFileFormat::BW64, "BW64"}}) {
+    // when
+    {
+      StreamingWavFileWriter writer{
+          {.absolutePath = testFile().getFullPathName().toStdString(),
+           .sampleRate = 48000_Hz,
+           .numChannels = 2,
+           .largeFileFormat = format}};
+      for (auto i = 0; i < NUM_BLOCKS; ++i) {
+        writer.append(channels, BLOCK_SIZE);
+      }
+    }  // closing finalizes the header and renames RF64 to BW64
+
+    // then
+    juce::FileInputStream stream{testFile()};
+    char fileId[4]{};
+    ASSERT_EQ(4, stream.read(fileId, 4));
+    EXPECT_EQ(id, std::string(fileId, 4u));
+    ASSERT_TRUE(stream.setPosition(0));
+    const auto layout = WavDataLayout::readFrom(stream);
+    EXPECT_EQ(2, layout.numChannels);
+    EXPECT_EQ(std::int64_t{NUM_BLOCKS} * BLOCK_SIZE,
+              layout.getLengthInSamples());
+
+    // cleanup
+    testFile().deleteFile();
+  }
+}
+}  // namespace wolfsound
@@ -0,0 +1,38 @@
+#include <gtest/gtest.h>
+#include <wolfsound/file/wolfsound_WavDataLayout.hpp>
+#include "largeFileFormat.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace wolfsound {
+TEST(WavDataLayout, TakesTheDataSizeOf64BitFilesFromDs64) {
+  const std::vector<std::int16_t> samples{0, 16384, -16384, 32767, -32768};
+
+  for (const auto* id : {"RF64", "BW64"}) {
+    // given
+    const auto file = largeFileFormat(id, samples);
+    juce::MemoryInputStream stream{file, false};
+
+    // when
+    const auto layout = WavDataLayout::readFrom(stream);
+
+    // then
+    EXPECT_EQ(1, layout.numChannels);
+    EXPECT_EQ(48000.0, layout.sampleRate);
+    EXPECT_EQ(16, layout.bitsPerSample);
+    EXPECT_EQ(std::ssize(samples), layout.getLengthInSamples());
+    EXPECT_EQ(static_cast<std::int64_t>(file.getSize()) -
+                  layout.dataSizeInBytes,
+              layout.dataOffset);
+  }
+}
+
+TEST(WavDataLayout, Rejects64BitFilesWithoutDs64) {
+  // given
+  const auto file = largeFileFormat("RF64", {0, 1, 2}, false);
+  juce::MemoryInputStream stream{file, false};
+
+  // when, then
+  EXPECT_THROW((void)WavDataLayout::readFrom(stream), std::runtime_error);
+}
+}  // namespace wolfsound
@@ -2,7 +2,10 @@
 #include <wolfsound/file/wolfsound_WavFileWriter.hpp>
 #include <wolfsound/file/wolfsound_WavFileReader.hpp>
 #include "wolfsound/dsp/wolfsound_testSignals.hpp"
+#include "largeFileFormat.hpp"
 #include <chrono>
+#include <cstdint>
+#include <vector>
 
 namespace wolfsound {
 TEST(WavFileReaderWriter, WriteAndReadFilePreservesContent) {
@@ -37,4 +40,104 @@ TEST(WavFileReaderWriter, WriteAndReadFilePreservesContent) {
   // cleanup
   testFile.deleteFile();
 }
+
+TEST(WavFileReaderWriter, ReadsTheSameSamplesAsynchronously) {
+  using namespace std::chrono_literals;
+
+  // given
+  const auto testSignal = generateWhiteNoise(48000_Hz, 1s, 0u);
+  const auto testFile =
+      juce::File::getSpecialLocation(
+          juce::File::SpecialLocationType::currentExecutableFile)
+          .getParentDirectory()
+          .getChildFile("asyncNoise.wav");
+  WavFileWriter::writeToFile(testFile.getFullPathName().toStdString(),
+                             testSignal, 48000_Hz);
+  WavFileReader reader{};
+  reader.loadFile(testFile);
+
+  // when
+  WavFileReader asyncReader{
+      {.asyncReading = AsyncWavFileReader::Args{.chunkSizeInBytes = 1000u}}};
+  asyncReader.loadFile(testFile);
+
+  // then
+  ASSERT_EQ(reader.getLengthInSamples(), asyncReader.getLengthInSamples());
+  EXPECT_EQ(reader.getSampleRate(), asyncReader.getSampleRate());
+  for (auto i = 0; i < int(reader.getLengthInSamples()); ++i) {
+    ASSERT_EQ(reader.getSamples().getSample(0, i),
+              asyncReader.getSamples().getSample(0, i));
+  }
+
+  // cleanup
+  testFile.deleteFile();
+}
+
+TEST(WavFileReaderWriter, WritesMultichannelBuffersAtHighBitDepths) {
+  using namespace std::chrono_literals;
+
+  // given
+  constexpr auto SAMPLE_RATE = 48000_Hz;
+  const auto left = generateWhiteNoise(SAMPLE_RATE, 100ms, 0u);
+  const auto right = generateWhiteNoise(SAMPLE_RATE, 100ms, 1u);
+  juce::AudioBuffer<float> buffer{2, static_cast<int>(left.size())};
+  buffer.copyFrom(0, 0, left.data(), buffer.getNumSamples());
+  buffer.copyFrom(1, 0, right.data(), buffer.getNumSamples());
+
+  const auto testFile =
+      juce::File::getSpecialLocation(
+          juce::File::SpecialLocationType::currentExecutableFile)
+          .getParentDirectory()
+          .getChildFile("stereoNoise.wav");
+
+  for (const auto& [encoding, tolerance] :
+       {std::pair{WavEncoding::INT24, 1e-6f},
+        std::pair{WavEncoding::FLOAT32, 0.f}}) {
+    // when
+    WavFileWriter{{.absolutePath = testFile.getFullPathName().toStdString(),
+                   .sampleRate = SAMPLE_RATE,
+                   .encoding = encoding}}
+        .write(buffer);
+
+    // then
+    WavFileReader reader;
+    reader.loadFile(testFile);
+    ASSERT_EQ(2, reader.getNumChannels());
+    ASSERT_EQ(left.size(), reader.getLengthInSamples());
+    for (auto channel = 0; channel < 2; ++channel) {
+      for (auto i = 0; i < buffer.getNumSamples(); ++i) {
+        EXPECT_NEAR(buffer.getSample(channel, i),
+                    reader.getSamples().getSample(channel, i), tolerance);
+      }
+    }
+  }
+
+  // cleanup
+  testFile.deleteFile();
+}
+
+TEST(WavFileReaderWriter, ReadsBw64Files) {
+  // given a BW64 file with its data size in the ds64 chunk
+  const std::vector<std::int16_t> samples{0, 16384, -16384, -32768};
+  const auto bytes = largeFileFormat("BW64", samples);
+  const auto testFile =
+      juce::File::getSpecialLocation(
+          juce::File::SpecialLocationType::currentExecutableFile)
+          .getParentDirectory()
+          .getChildFile("bw64.wav");
+  ASSERT_TRUE(testFile.replaceWithData(bytes.getData(), bytes.getSize()));
+
+  // when
+  WavFileReader reader{};
+  reader.loadFile(testFile);
+
+  // then
+  ASSERT_EQ(samples.size(), reader.getLengthInSamples());
+  for (auto i = 0u; i < samples.size(); ++i) {
+    EXPECT_EQ(samples[i] / 32768.f, reader.getSamples().getSample(0, int(i)));
+  }
+
+  // cleanup
+  testFile.deleteFile();
+}
 }  // namespace wolfsound
@@ -0,0 +1,179 @@
+#include <gtest/gtest.h>
+#include <wolfsound/file/wolfsound_WaveformOverview.hpp>
+#include <wolfsound/file/wolfsound_WavFileWriter.hpp>
+#include "wolfsound/dsp/wolfsound_testSignals.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace wolfsound {
+namespace {
+OverviewBucket summarize(std::span<const float> samples) {
+  const auto [min, max] = std::ranges::minmax(samples);
+  auto sumOfSquares = 0.0;
+  for (const auto sample : samples) {
+    sumOfSquares += sample * sample;
+  }
+  return {.min = min,
+          .max = max,
+          .rms = static_cast<float>(std::sqrt(sumOfSquares / samples.size()))};
+}
+
+WaveformOverview buildInIrregularBlocks(const std::vector<float>& signal,
+                                        WaveformOverview::Args args) {
+  WaveformOverview::Builder builder{1, 48000.0, args};
+  auto start = std::size_t{0};
+  for (auto blockSize = std::size_t{1}; start < signal.size();
+       blockSize = blockSize * 3 % 1001) {
+    const auto length = std::min(blockSize, signal.size() - start);
+    const float* channels[] = {signal.data() + start};
+    builder.addBlock(channels, static_cast<int>(length));
+    start += length;
+  }
+  return std::move(builder).finish();
+}
+}  // namespace
+
+TEST(WaveformOverview, LevelsSummarizeTheirSamples) {
+  using namespace std::chrono_literals;
+
+  // given
+  const auto signal = generateWhiteNoise(48000_Hz, 1s, 0u);
+
+  // when
+  const auto overview =
+      buildInIrregularBlocks(signal, {.samplesPerBucket = 100,
+                                      .decimationFactor = 3});
+
+  // then
+  EXPECT_EQ(std::ssize(signal), overview.getLengthInSamples());
+  EXPECT_EQ(1u, overview.getLevel(overview.getNumLevels() - 1, 0).size());
+  for (auto level = 0; level < overview.getNumLevels(); ++level) {
+    const auto samplesPerBucket = overview.getSamplesPerBucket(level);
+    const auto buckets = overview.getLevel(level, 0);
+    ASSERT_EQ((signal.size() + samplesPerBucket - 1) / samplesPerBucket,
+              buckets.size());
+    for (auto bucket = 0u; bucket < buckets.size(); ++bucket) {
+      const auto start = bucket * samplesPerBucket;
+      const auto expected = summarize(std::span{signal}.subspan(
+          start, std::min<std::size_t>(samplesPerBucket,
+                                       signal.size() - start)));
+      EXPECT_EQ(expected.min, buckets[bucket].min);
+      EXPECT_EQ(expected.max, buckets[bucket].max);
+      EXPECT_NEAR(expected.rms, buckets[bucket].rms, 1e-5f);
+    }
+  }
+}
+
+TEST(WaveformOverview, PixelsSummarizeTheirRange) {
+  using namespace std::chrono_literals;
+
+  // given
+  const auto signal = generateWhiteNoise(48000_Hz, 1s, 1u);
+  const auto overview =
+      buildInIrregularBlocks(signal, {.samplesPerBucket = 64,
+                                      .decimationFactor = 4});
+
+  for (const auto& [start, length] :
+       {std::pair{0, 40960}, std::pair{1024, 10240}, std::pair{128, 640}}) {
+    // when
+    std::vector<OverviewBucket> pixels(10);
+    overview.getPixels(0, start, length, pixels);
+
+    // then (pixel boundaries coincide with bucket boundaries)
+    for (auto pixel = 0; pixel < 10; ++pixel) {
+      const auto expected = summarize(std::span{signal}.subspan(
+          static_cast<std::size_t>(start + pixel * length / 10),
+          static_cast<std::size_t>(length / 10)));
+      EXPECT_EQ(expected.min, pixels[pixel].min);
+      EXPECT_EQ(expected.max, pixels[pixel].max);
+      EXPECT_NEAR(expected.rms, pixels[pixel].rms, 1e-5f);
+    }
+  }
+}
+
+TEST(WaveformOverview, SidecarIsReusedUntilTheFileChanges) {
+  using namespace std::chrono_literals;
+
+  // given
+  constexpr auto SAMPLE_RATE = 48000_Hz;
+  const auto testFile =
+      juce::File::getSpecialLocation(
+          juce::File::SpecialLocationType::currentExecutableFile)
+          .getParentDirectory()
+          .getChildFile("overviewNoise.wav");
+  const auto overviewFile = testFile.getSiblingFile(
+      "overviewNoise.wav" + juce::String{WaveformOverview::FILE_EXTENSION});
+  WavFileWriter::writeToFile(testFile.getFullPathName().toStdString(),
+                             generateWhiteNoise(SAMPLE_RATE, 1s, 0u),
+                             SAMPLE_RATE);
+
+  // when
+  const auto built = WaveformOverview::loadOrBuild(testFile);
+  const auto loaded = WaveformOverview::load(overviewFile, testFile);
+
+  // then
+  ASSERT_TRUE(loaded.has_value());
+  EXPECT_EQ(built.getNumLevels(), loaded->getNumLevels());
+  EXPECT_EQ(SAMPLE_RATE.value(), loaded->getSampleRate());
+  for (auto level = 0; level < built.getNumLevels(); ++level) {
+    EXPECT_TRUE(std::ranges::equal(
+        built.getLevel(level, 0), loaded->getLevel(level, 0),
+        [](const auto& a, const auto& b) {
+          return a.min == b.min && a.max == b.max && a.rms == b.rms;
+        }));
+  }
+
+  // when
+  WavFileWriter::writeToFile(testFile.getFullPathName().toStdString(),
+                             generateWhiteNoise(SAMPLE_RATE, 1s, 2u),
+                             SAMPLE_RATE);
+  // a timestamp that differs for sure makes the content hash decide
+  testFile.setLastModificationTime(juce::Time{0});
+
+  // then
+  EXPECT_FALSE(WaveformOverview::load(overviewFile, testFile).has_value());
+
+  // cleanup
+  testFile.deleteFile();
+  overviewFile.deleteFile();
+}
+
+TEST(WaveformOverview, TouchedSourceIsHashedOnlyOnce) {
+  using namespace std::chrono_literals;
+
+  // given
+  constexpr auto SAMPLE_RATE = 48000_Hz;
+  const auto testFile =
+      juce::File::getSpecialLocation(
+          juce::File::SpecialLocationType::currentExecutableFile)
+          .getParentDirectory()
+          .getChildFile("touchedNoise.wav");
+  const auto overviewFile = testFile.getSiblingFile(
+      "touchedNoise.wav" + juce::String{WaveformOverview::FILE_EXTENSION});
+  WavFileWriter::writeToFile(testFile.getFullPathName().toStdString(),
+                             generateWhiteNoise(SAMPLE_RATE, 1s, 1u),
+                             SAMPLE_RATE);
+  static_cast<void>(WaveformOverview::loadOrBuild(testFile));
+
+  // when
+  testFile.setLastModificationTime(juce::Time{1000});
+
+  // then
+  ASSERT_TRUE(WaveformOverview::load(overviewFile, testFile).has_value());
+
+  // when
+  WavFileWriter::writeToFile(testFile.getFullPathName().toStdString(),
+                             generateWhiteNoise(SAMPLE_RATE, 1s, 2u),
+                             SAMPLE_RATE);
+  testFile.setLastModificationTime(juce::Time{1000});
+
+  // then
+  // the sidecar took the new timestamp over, so the contents are not hashed
+  EXPECT_TRUE(WaveformOverview::load(overviewFile, testFile).has_value());
+
+  // cleanup
+  testFile.deleteFile();
+  overviewFile.deleteFile();
+}
+}  // namespace wolfsound
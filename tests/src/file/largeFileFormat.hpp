@@ -0,0 +1,43 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <cstdint>
+#include <vector>
+
+namespace wolfsound {
+/** @brief The bytes of a mono 16-bit 48 kHz file with the given ID, e.g.,
+ * RF64 or BW64, whose RIFF and data sizes are in ds64. */
+inline juce::MemoryBlock largeFileFormat(
+    const char* id,
+    const std::vector<std::int16_t>& samples,
+    bool withDs64 = true) {
+  const auto dataSize = static_cast<juce::int64>(samples.size() * 2u);
+  juce::MemoryBlock file;
+  juce::MemoryOutputStream stream{file, false};
+  stream.write(id, 4);
+  stream.writeInt(-1);
+  stream.write("WAVE", 4);
+  if (withDs64) {
+    stream.write("ds64", 4);
+    stream.writeInt(28);
+    stream.writeInt64(4 + 36 + 24 + 8 + dataSize);
+    stream.writeInt64(dataSize);
+    stream.writeInt64(std::ssize(samples));
+    stream.writeInt(0);  // no table of other oversized chunks
+  }
+  stream.write("fmt ", 4);
+  stream.writeInt(16);
+  stream.writeShort(1);  // PCM
+  stream.writeShort(1);
+  stream.writeInt(48000);
+  stream.writeInt(96000);
+  stream.writeShort(2);
+  stream.writeShort(16);
+  stream.write("data", 4);
+  stream.writeInt(-1);
+  for (const auto sample : samples) {
+    stream.writeShort(sample);
+  }
+  return file;
+}
+}  // namespace wolfsound
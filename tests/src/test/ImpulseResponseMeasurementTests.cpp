@@ -0,0 +1,40 @@
+#include <gtest/gtest.h>
+#include <wolfsound/dsp/wolfsound_testSignals.hpp>
+#include <wolfsound/test/wolfsound_ImpulseResponseMeasurement.hpp>
+#include <chrono>
+#include <cmath>
+
+namespace wolfsound {
+TEST(ImpulseResponseMeasurement, MeasuresLatencyAndTail) {
+  using namespace std::chrono_literals;
+
+  // given a delayed impulse decaying by 6 dB per sample
+  auto response = generateImpulse(1000_Hz, 1s);
+  std::ranges::rotate(response, response.end() - 12);
+  for (auto i = 13u; i < response.size(); ++i) {
+    response[i] = 0.5f * response[i - 1u];
+  }
+
+  // when
+  const auto measurement =
+      ImpulseResponseMeasurement::from(response, DecibelsFullScale{-60.f});
+
+  // then the last sample at -60 dBFS or above is 2^-9 at -54 dBFS
+  ASSERT_TRUE(measurement.has_value());
+  EXPECT_EQ(12, measurement->latencyInSamples);
+  EXPECT_EQ(9, measurement->tailLengthInSamples);
+  EXPECT_EQ(1.f, measurement->peak);
+}
+
+TEST(ImpulseResponseMeasurement, SilenceHasNoResponse) {
+  // given
+  const std::vector<float> silence(64, 1e-4f);
+
+  // when
+  const auto measurement =
+      ImpulseResponseMeasurement::from(silence, DecibelsFullScale{-60.f});
+
+  // then
+  EXPECT_FALSE(measurement.has_value());
+}
+}  // namespace wolfsound
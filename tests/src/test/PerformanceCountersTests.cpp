@@ -0,0 +1,38 @@
+#include <gtest/gtest.h>
+#include <wolfsound/test/wolfsound_PerformanceCounters.hpp>
+#include <cstdint>
+
+namespace wolfsound {
+TEST(PerformanceCounters, CountsTheInstructionsBetweenStartAndStop) {
+  // given
+  PerformanceCounters counters;
+  if (!counters.isAvailable()) {
+    GTEST_SKIP() << "no hardware performance counters on this system";
+  }
+  volatile std::uint64_t sum = 0u;
+
+  // when
+  counters.start();
+  for (auto i = 0; i < 1'000'000; ++i) {
+    sum = sum + 1u;
+  }
+  counters.stop();
+
+  // then
+  const auto totals = counters.getTotals();
+  if (totals.instructions.has_value()) {
+    EXPECT_GT(*totals.instructions, 1'000'000u);
+  }
+}
+
+TEST(PerformanceCounters, DividesInstructionsByCycles) {
+  // given
+  PerformanceCounterValues values;
+  values.cycles = 100u;
+  values.instructions = 250u;
+
+  // then
+  EXPECT_EQ(2.5, values.instructionsPerCycle());
+  EXPECT_FALSE(PerformanceCounterValues{}.instructionsPerCycle().has_value());
+}
+}  // namespace wolfsound
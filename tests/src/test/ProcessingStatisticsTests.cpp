@@ -0,0 +1,51 @@
+#include <gtest/gtest.h>
+#include <wolfsound/test/wolfsound_ProcessingStatistics.hpp>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+namespace wolfsound {
+TEST(ProcessingStatistics, SummarizesBlockTimings) {
+  using namespace std::chrono_literals;
+
+  // given 1000 blocks of 480 samples, i.e., 10 ms each at 48 kHz
+  std::vector<BlockTiming> blocks;
+  for (auto i = 0; i < 1000; ++i) {
+    blocks.push_back({.startSample = i * 480,
+                      .numSamples = 480,
+                      .wallTime = std::chrono::microseconds{i + 1},
+                      .cpuTime = std::chrono::microseconds{1}});
+  }
+  blocks[500].wallTime = 20ms;
+
+  // when
+  const auto statistics = ProcessingStatistics::from(blocks, 48000.0);
+
+  // then
+  EXPECT_EQ(1000, statistics.numBlocks);
+  EXPECT_EQ(480000, statistics.numSamples);
+  EXPECT_EQ(1, statistics.numBlocksOverBudget);
+  EXPECT_EQ(500us, statistics.wallTime.p50);
+  EXPECT_EQ(991us, statistics.wallTime.p99);
+  EXPECT_EQ(1000us, statistics.wallTime.p999);
+  EXPECT_EQ(20ms, statistics.wallTime.max);
+  EXPECT_EQ(1us, statistics.cpuTime.max);
+  EXPECT_EQ(1ms, statistics.totalCpuTime);
+  EXPECT_DOUBLE_EQ(0.0001, statistics.cpuRealTimeFactor);
+}
+
+TEST(ProcessingStatistics, MeasuresTheWallTimeOfABlock) {
+  using namespace std::chrono_literals;
+
+  // when
+  const auto timing =
+      measureBlock(64, 32, [] { std::this_thread::sleep_for(2ms); });
+
+  // then
+  EXPECT_EQ(64, timing.startSample);
+  EXPECT_EQ(32, timing.numSamples);
+  EXPECT_GE(timing.wallTime, 2ms);
+  // sleeping costs (almost) no CPU time
+  EXPECT_LT(timing.cpuTime, timing.wallTime);
+}
+}  // namespace wolfsound
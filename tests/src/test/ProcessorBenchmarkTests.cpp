@@ -0,0 +1,160 @@
+#include <gtest/gtest.h>
+#include <wolfsound/test/wolfsound_ProcessorBenchmark.hpp>
+#include <wolfsound/test/wolfsound_TestAudioProcessorBase.hpp>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+
+namespace wolfsound {
+namespace {
+class CountingAudioProcessor : public TestAudioProcessorBase {
+public:
+  void processBlock(juce::AudioBuffer<float>& buffer,
+                    juce::MidiBuffer&) override {
+    ++numBlocks;
+    numSamples += buffer.getNumSamples();
+  }
+
+  int numBlocks = 0;
+  int numSamples = 0;
+};
+
+class ThrowingAudioProcessor : public TestAudioProcessorBase {
+public:
+  explicit ThrowingAudioProcessor(int throwingBlock)
+      : throwingBlock_{throwingBlock} {}
+
+  void processBlock(juce::AudioBuffer<float>&, juce::MidiBuffer&) override {
+    if (numBlocks_++ == throwingBlock_) {
+      throw std::runtime_error{"processing failed"};
+    }
+  }
+
+private:
+  int throwingBlock_;
+  int numBlocks_ = 0;
+};
+}  // namespace
+
+TEST(ProcessorBenchmark, RunsEveryConfiguration) {
+  using namespace std::chrono_literals;
+
+  // given
+  CountingAudioProcessor processor;
+  ProcessorBenchmark benchmark{{.sampleRates = {1000.0, 2000.0},
+                                .blockSizes = {10, 100},
+                                .channelLayouts = {{1, 1}, {2, 2}},
+                                .duration = 1s,
+                                .numWarmUpBlocks = 2}};
+
+  // when
+  const auto results = benchmark.run(processor);
+
+  // then
+  ASSERT_EQ(8u, results.size());
+  const auto& last = results.back();
+  EXPECT_EQ(2000.0, last.sampleRate);
+  EXPECT_EQ(100, last.blockSize);
+  EXPECT_EQ(2, last.numInputChannels);
+  EXPECT_TRUE(last.supported);
+  EXPECT_EQ(20, last.statistics.numBlocks);
+  EXPECT_EQ(2000, last.statistics.numSamples);
+  EXPECT_GT(last.samplesPerSecond, 0.0);
+
+  // warm-up blocks are processed but not measured
+  EXPECT_EQ(2 * (100 + 10 + 200 + 20) + 8 * 2, processor.numBlocks);
+}
+
+TEST(ProcessorBenchmark, ReadsPerformanceCountersIfAsked) {
+  using namespace std::chrono_literals;
+
+  // given
+  CountingAudioProcessor processor;
+  ProcessorBenchmark benchmark{{.sampleRates = {1000.0},
+                                .blockSizes = {10},
+                                .duration = 1s,
+                                .readPerformanceCounters = true}};
+
+  // when
+  const auto results = benchmark.run(processor);
+
+  // then
+  ASSERT_EQ(1u, results.size());
+  // the counts themselves are empty where the system has no counters
+  EXPECT_TRUE(results.front().performanceCounters.has_value());
+}
+
+TEST(ProcessorBenchmark, RunsInstancesInParallel) {
+  using namespace std::chrono_literals;
+
+  // given
+  ProcessorBenchmark benchmark{{.duration = 1s, .numWarmUpBlocks = 2}};
+
+  // when
+  const auto results = benchmark.runScaling(
+      [] { return std::make_unique<CountingAudioProcessor>(); },
+      {.numInstances = {1, 3}, .sampleRate = 1000.0, .blockSize = 10});
+
+  // then
+  ASSERT_EQ(2u, results.size());
+  EXPECT_EQ(1, results[0].numInstances);
+  ASSERT_EQ(3u, results[1].instances.size());
+  for (const auto& instance : results[1].instances) {
+    EXPECT_EQ(100, instance.numBlocks);
+  }
+  EXPECT_GT(results[1].aggregateSamplesPerSecond, 0.0);
+}
+
+TEST(ProcessorBenchmark, ReportsWhetherScalingThreadsArePinned) {
+  using namespace std::chrono_literals;
+
+  // given
+  ProcessorBenchmark benchmark{{.duration = 1s, .numWarmUpBlocks = 2}};
+  const auto createProcessor = [] {
+    return std::make_unique<CountingAudioProcessor>();
+  };
+
+  // when
+  const auto pinned = benchmark.runScaling(
+      createProcessor,
+      {.numInstances = {2}, .sampleRate = 1000.0, .blockSize = 10});
+  const auto unpinned = benchmark.runScaling(createProcessor,
+                                             {.numInstances = {2},
+                                              .sampleRate = 1000.0,
+                                              .blockSize = 10,
+                                              .pinThreads = false});
+
+  // then
+#if defined(__linux__)
+  EXPECT_TRUE(pinned.front().threadsPinned);
+#endif
+  EXPECT_FALSE(unpinned.front().threadsPinned);
+}
+
+TEST(ProcessorBenchmark, RethrowsWhatAnInstanceThrows) {
+  using namespace std::chrono_literals;
+
+  // given
+  ProcessorBenchmark benchmark{{.duration = 1s, .numWarmUpBlocks = 2}};
+
+  // during the warm-up and during the measurement
+  for (const auto throwingBlock : {0, 50}) {
+    auto numCreated = 0;
+    const auto createProcessor =
+        [&]() -> std::unique_ptr<juce::AudioProcessor> {
+      // only the second instance fails
+      if (numCreated++ == 1) {
+        return std::make_unique<ThrowingAudioProcessor>(throwingBlock);
+      }
+      return std::make_unique<CountingAudioProcessor>();
+    };
+
+    // when, then the other instances do not wait for it forever
+    EXPECT_THROW(
+        (void)benchmark.runScaling(
+            createProcessor,
+            {.numInstances = {3}, .sampleRate = 1000.0, .blockSize = 10}),
+        std::runtime_error);
+  }
+}
+}  // namespace wolfsound
@@ -0,0 +1,162 @@
+#include <gtest/gtest.h>
+#include <wolfsound/test/wolfsound_ProcessorFileIoTestSuite.hpp>
+#include "processorFileIoTestFixtures.hpp"
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace wolfsound {
+namespace {
+using Suite = ProcessorFileIoTestSuite<OnePoleLowPass>;
+
+juce::File testDirectory() {
+  return juce::File::getSpecialLocation(
+             juce::File::SpecialLocationType::currentExecutableFile)
+      .getParentDirectory()
+      .getChildFile("processorFileIoTestSuite");
+}
+
+Suite::Spec specFor(const std::string& inputFile, const std::string& name) {
+  return {.inputAudioFile = inputFile,
+          .name = name,
+          .audioInputFilesDirectoryPath =
+              testDirectory().getFullPathName().toStdString(),
+          .blockSchedule = {.blockSize = 128, .minBlockSize = 16},
+          .writeStatisticsFile = false};
+}
+}  // namespace
+
+TEST(ProcessorFileIoTestSuite, OutputsDoNotDependOnTheNumberOfThreads) {
+  // given
+  writeNoiseFile(testDirectory().getChildFile("short.wav"), 1, 1000);
+  writeNoiseFile(testDirectory().getChildFile("long.wav"), 2, 5000);
+  std::vector<Suite::Spec> specs;
+  for (const auto* input : {"short.wav", "long.wav"}) {
+    for (auto seed = 0u; seed < 3u; ++seed) {
+      auto spec = specFor(input, "seed" + std::to_string(seed));
+      spec.blockSchedule.seed = seed;
+      specs.push_back(spec);
+    }
+  }
+  const auto runOn = [&](unsigned numThreads) {
+    const auto outputDirectory =
+        testDirectory().getChildFile(std::to_string(numThreads));
+    outputDirectory.createDirectory();
+    auto specsOnThreads = specs;
+    for (auto& spec : specsOnThreads) {
+      spec.audioOutputFilesDirectoryPath =
+          outputDirectory.getFullPathName().toStdString();
+    }
+    return Suite{{.numThreads = numThreads}}.run(specsOnThreads);
+  };
+
+  // when
+  const auto oneThread = runOn(1u);
+  const auto fourThreads = runOn(4u);
+
+  // then
+  ASSERT_EQ(specs.size(), oneThread.size());
+  ASSERT_EQ(specs.size(), fourThreads.size());
+  for (auto i = 0u; i < specs.size(); ++i) {
+    ASSERT_TRUE(oneThread[i].succeeded) << oneThread[i].errorMessage;
+    ASSERT_TRUE(fourThreads[i].succeeded) << fourThreads[i].errorMessage;
+    EXPECT_EQ(oneThread[i].statistics.numBlocks,
+              fourThreads[i].statistics.numBlocks);
+    juce::MemoryBlock expected;
+    juce::MemoryBlock actual;
+    ASSERT_TRUE(oneThread[i].outputFile.loadFileAsData(expected));
+    ASSERT_TRUE(fourThreads[i].outputFile.loadFileAsData(actual));
+    EXPECT_EQ(expected, actual) << specs[i].inputAudioFile << " "
+                                << specs[i].name;
+  }
+
+  // cleanup
+  testDirectory().deleteRecursively();
+}
+
+TEST(ProcessorFileIoTestSuite, DecodesAnInputSharedBySpecsOnce) {
+  // given
+  writeNoiseFile(testDirectory().getChildFile("input.wav"), 1, 1000);
+  const std::vector<Suite::Spec> specs{specFor("input.wav", "first"),
+                                       specFor("input.wav", "second"),
+                                       specFor("input.wav", "third")};
+  const auto cache = std::make_shared<DecodedAudioCache>(1u << 20u);
+
+  // when
+  const auto results =
+      Suite{{.numThreads = 3u, .inputCache = cache}}.run(specs);
+
+  // then
+  for (const auto& result : results) {
+    EXPECT_TRUE(result.succeeded) << result.errorMessage;
+  }
+  const auto statistics = cache->getStatistics();
+  EXPECT_EQ(1u, statistics.misses);
+  EXPECT_EQ(2u, statistics.hits);
+
+  // cleanup
+  testDirectory().deleteRecursively();
+}
+
+TEST(ProcessorFileIoTestSuite, RejectsSpecsWithTheSameOutputFile) {
+  // given
+  writeNoiseFile(testDirectory().getChildFile("input.wav"), 1, 1000);
+  const std::vector<Suite::Spec> specs{specFor("input.wav", "same"),
+                                       specFor("input.wav", "other"),
+                                       specFor("input.wav", "same")};
+
+  // when, then
+  EXPECT_THROW((void)Suite{{.numThreads = 1u}}.run(specs),
+               std::runtime_error);
+
+  // cleanup
+  testDirectory().deleteRecursively();
+}
+
+TEST(ProcessorFileIoTestSuite, ReportsFailuresWithoutAbortingTheOthers) {
+  // given
+  writeNoiseFile(testDirectory().getChildFile("input.wav"), 1, 1000);
+  const std::vector<Suite::Spec> specs{specFor("input.wav", "first"),
+                                       specFor("missing.wav", "second"),
+                                       specFor("input.wav", "third")};
+
+  // when
+  const auto results = Suite{{.numThreads = 2u}}.run(specs);
+
+  // then
+  ASSERT_EQ(3u, results.size());
+  EXPECT_TRUE(results[0].succeeded) << results[0].errorMessage;
+  EXPECT_TRUE(results[0].outputFile.existsAsFile());
+  EXPECT_FALSE(results[1].succeeded);
+  EXPECT_FALSE(results[1].errorMessage.empty());
+  EXPECT_TRUE(results[2].succeeded) << results[2].errorMessage;
+  EXPECT_TRUE(results[2].outputFile.existsAsFile());
+
+  // cleanup
+  testDirectory().deleteRecursively();
+}
+
+TEST(ProcessorFileIoTestSuite, CutsSpecsWithoutABlockSizeIntoDefaultBlocks) {
+  // given
+  writeNoiseFile(testDirectory().getChildFile("input.wav"), 1, 1000);
+  auto spec = specFor("input.wav", "whole");
+  spec.blockSchedule = {};
+  const std::vector<Suite::Spec> specs{spec};
+
+  // when
+  const auto blocked =
+      Suite{{.numThreads = 1u, .defaultBlockSize = 256}}.run(specs);
+  const auto whole =
+      Suite{{.numThreads = 1u, .defaultBlockSize = 0}}.run(specs);
+
+  // then
+  ASSERT_TRUE(blocked[0].succeeded) << blocked[0].errorMessage;
+  ASSERT_TRUE(whole[0].succeeded) << whole[0].errorMessage;
+  EXPECT_EQ(4, blocked[0].statistics.numBlocks);
+  EXPECT_EQ(1, whole[0].statistics.numBlocks);
+
+  // cleanup
+  testDirectory().deleteRecursively();
+}
+}  // namespace wolfsound
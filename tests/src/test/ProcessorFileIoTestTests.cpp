@@ -0,0 +1,527 @@
+#include <gtest/gtest.h>
+#include <wolfsound/file/wolfsound_WavFileReader.hpp>
+#include <wolfsound/test/wolfsound_ProcessorFileIoTest.hpp>
+#include "processorFileIoTestFixtures.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace wolfsound {
+namespace {
+juce::File testDirectory() {
+  return juce::File::getSpecialLocation(
+             juce::File::SpecialLocationType::currentExecutableFile)
+      .getParentDirectory()
+      .getChildFile("processorFileIoTest");
+}
+
+void writeInputFile(const std::string& filename,
+                    int numChannels,
+                    int numSamples) {
+  writeNoiseFile(testDirectory().getChildFile(filename), numChannels,
+                 numSamples);
+}
+
+void expectEqualSamples(const juce::AudioBuffer<float>& expected,
+                        int expectedChannel,
+                        const juce::AudioBuffer<float>& actual,
+                        int actualChannel) {
+  ASSERT_EQ(expected.getNumSamples(), actual.getNumSamples());
+  for (auto i = 0; i < expected.getNumSamples(); ++i) {
+    ASSERT_EQ(expected.getSample(expectedChannel, i),
+              actual.getSample(actualChannel, i))
+        << "at sample " << i;
+  }
+}
+
+struct PassThrough {
+  void prepare(const juce::dsp::ProcessSpec&) {}
+
+  template <typename Context>
+  void process(const Context&) {}
+};
+
+/** @brief Passes the input through and checks the channel count. */
+struct ChannelCounter {
+  void prepare(const juce::dsp::ProcessSpec& spec) {
+    numChannels = spec.numChannels;
+  }
+
+  template <typename Context>
+  void process(const Context& context) {
+    EXPECT_EQ(numChannels, context.getOutputBlock().getNumChannels());
+  }
+
+  juce::uint32 numChannels = 0u;
+};
+
+/** @brief Delays the input by a set number of samples and reports a
+ * possibly different latency. */
+struct DelayingProcessor {
+  void prepare(const juce::dsp::ProcessSpec& spec) {
+    delayLines.assign(spec.numChannels, std::vector<float>(DELAY, 0.f));
+    position = 0u;
+  }
+
+  template <typename Context>
+  void process(const Context& context) {
+    const auto& block = context.getOutputBlock();
+    for (auto i = 0u; i < block.getNumSamples(); ++i) {
+      for (auto channel = 0u; channel < block.getNumChannels(); ++channel) {
+        auto& delayed = delayLines[channel][position];
+        std::swap(delayed, block.getChannelPointer(channel)[i]);
+      }
+      position = (position + 1u) % DELAY;
+    }
+  }
+
+  [[nodiscard]] int getLatencyInSamples() const { return reportedLatency; }
+
+  static constexpr std::size_t DELAY = 32u;
+  int reportedLatency = static_cast<int>(DELAY);
+  std::vector<std::vector<float>> delayLines;
+  std::size_t position = 0u;
+};
+
+template <typename Processor = PassThrough>
+using Spec = typename ProcessorFileIoTest<Processor>::Spec;
+
+template <typename Processor = PassThrough>
+Spec<Processor> specFor(const std::string& inputFile) {
+  return {.inputAudioFile = inputFile,
+          .audioInputFilesDirectoryPath =
+              testDirectory().getFullPathName().toStdString(),
+          .writeStatisticsFile = false};
+}
+
+juce::File inputFile(const std::string& filename) {
+  return testDirectory().getChildFile(filename);
+}
+
+WavFileReader load(const juce::File& file) {
+  WavFileReader reader;
+  reader.loadFile(file);
+  return reader;
+}
+
+std::vector<std::pair<std::int64_t, int>> blocksOf(
+    const std::vector<BlockTiming>& timings) {
+  std::vector<std::pair<std::int64_t, int>> blocks;
+  for (const auto& timing : timings) {
+    blocks.emplace_back(timing.startSample, timing.numSamples);
+  }
+  return blocks;
+}
+}  // namespace
+
+TEST(ProcessorFileIoTest, CutsTheFileIntoBlocksOfTheGivenSize) {
+  // given
+  writeInputFile("input.wav", 1, 1000);
+  auto spec = specFor("input.wav");
+  spec.blockSchedule = {.blockSize = 256};
+  ProcessorFileIoTest<PassThrough> test{spec};
+
+  // when
+  test.run();
+
+  // then the last block is shorter
+  const std::vector<std::pair<std::int64_t, int>> expected{
+      {0, 256}, {256, 256}, {512, 256}, {768, 232}};
+  EXPECT_EQ(expected, blocksOf(test.getBlockTimings()));
+
+  // cleanup
+  testDirectory().deleteRecursively();
+}
+
+TEST(ProcessorFileIoTest, ProcessesTheWholeFileAtOnceWithoutBlockSize) {
+  // given
+  writeInputFile("input.wav", 1, 1000);
+  ProcessorFileIoTest<PassThrough> test{specFor("input.wav")};
+
+  // when
+  test.run();
+
+  // then
+  const std::vector<std::pair<std::int64_t, int>> expected{{0, 1000}};
+  EXPECT_EQ(expected, blocksOf(test.getBlockTimings()));
+
+  // cleanup
+  testDirectory().deleteRecursively();
+}
+
+TEST(ProcessorFileIoTest, RandomBlockSizesAreReproducible) {
+  // given
+  writeInputFile("input.wav", 1, 300);
+  auto spec = specFor("input.wav");
+  spec.blockSchedule = {.blockSize = 100, .minBlockSize = 10, .seed = 3u};
+  ProcessorFileIoTest<PassThrough> test{spec};
+
+  // when
+  test.run();
+
+  // then the sizes only depend on std::mt19937, so they are the same with
+  // every standard library; the last block is cut at the end of the file
+  const std::vector<std::pair<std::int64_t, int>> expected{
+      {0, 64}, {64, 55}, {119, 41}, {160, 91}, {251, 10}, {261, 39}};
+  EXPECT_EQ(expected, blocksOf(test.getBlockTimings()));
+
+  // cleanup
+  testDirectory().deleteRecursively();
+}
+
+TEST(ProcessorFileIoTest, ProcessesAllChannelsOfTheInputByDefault) {
+  // given
+  writeInputFile("input.wav", 2, 1000);
+  ProcessorFileIoTest<ChannelCounter> test{specFor<ChannelCounter>(
+      "input.wav")};
+
+  // when
+  test.run();
+
+  // then
+  EXPECT_EQ(2, test.getNumChannels());
+  const auto input = load(inputFile("input.wav"));
+  const auto output = load(juce::File{test.getOutputFilePath()});
+  ASSERT_EQ(2, output.getNumChannels());
+  expectEqualSamples(input.getSamples(), 0, output.getSamples(), 0);
+  expectEqualSamples(input.getSamples(), 1, output.getSamples(), 1);
+
+  // cleanup
+  testDirectory().deleteRecursively();
+}
+
+TEST(ProcessorFileIoTest, RepeatsAMonoInputOnAllChannels) {
+  // given
+  writeInputFile("input.wav", 1, 1000);
+  auto spec = specFor<ChannelCounter>("input.wav");
+  spec.numChannels = 2;
+  spec.blockSchedule = {.blockSize = 128};
+  ProcessorFileIoTest<ChannelCounter> test{spec};
+
+  // when
+  test.run();
+
+  // then
+  const auto input = load(inputFile("input.wav"));
+  const auto output = load(juce::File{test.getOutputFilePath()});
+  ASSERT_EQ(2, output.getNumChannels());
+  expectEqualSamples(input.getSamples(), 0, output.getSamples(), 0);
+  expectEqualSamples(input.getSamples(), 0, output.getSamples(), 1);
+
+  // cleanup
+  testDirectory().deleteRecursively();
+}
+
+TEST(ProcessorFileIoTest, RejectsAnInputWithoutChannels) {
+  // given a header with no channels and no samples
+  juce::MemoryBlock bytes;
+  {
+    juce::MemoryOutputStream stream{bytes, false};
+    stream.write("RIFF", 4);
+    stream.writeInt(36);
+    stream.write("WAVEfmt ", 8);
+    stream.writeInt(16);
+    stream.writeShort(1);  // PCM
+    stream.writeShort(0);
+    stream.writeInt(48000);
+    stream.writeInt(0);
+    stream.writeShort(0);
+    stream.writeShort(16);
+    stream.write("data", 4);
+    stream.writeInt(0);
+  }
+  testDirectory().createDirectory();
+  ASSERT_TRUE(inputFile("input.wav").replaceWithData(bytes.getData(),
+                                                     bytes.getSize()));
+  auto spec = specFor("input.wav");
+  spec.numChannels = 2;
+  ProcessorFileIoTest<PassThrough> test{spec};
+
+  // when, then
+  EXPECT_THROW(test.run(), std::runtime_error);
+
+  // cleanup
+  testDirectory().deleteRecursively();
+}
+
+TEST(ProcessorFileIoTest, StreamingEqualsProcessingTheWholeFileInMemory) {
+  // given a block size that does not divide the length
+  constexpr auto BLOCK_SIZE = 96;
+  writeInputFile("input.wav", 2, 1000);
+  auto spec = specFor<OnePoleLowPass>("input.wav");
+  spec.blockSchedule = {.blockSize = BLOCK_SIZE};
+  ProcessorFileIoTest<OnePoleLowPass> test{spec};
+
+  // when
+  test.run();
+
+  // then the output is that of the whole file processed in memory
+  auto expected = load(inputFile("input.wav")).getSamples();
+  OnePoleLowPass processor;
+  processor.prepare({.sampleRate = 48000.0,
+                     .maximumBlockSize = BLOCK_SIZE,
+                     .numChannels = 2u});
+  juce::dsp::AudioBlock<float> wholeFile{expected};
+  for (auto start = 0u; start < wholeFile.getNumSamples();
+       start += BLOCK_SIZE) {
+    auto block = wholeFile.getSubBlock(
+        start, std::min<std::size_t>(BLOCK_SIZE,
+                                     wholeFile.getNumSamples() - start));
+    processor.process(juce::dsp::ProcessContextReplacing<float>{block});
+  }
+  const auto output = load(juce::File{test.getOutputFilePath()});
+  ASSERT_EQ(2, output.getNumChannels());
+  ASSERT_EQ(1000u, output.getLengthInSamples());
+  for (auto channel = 0; channel < 2; ++channel) {
+    for (auto i = 0; i < 1000; ++i) {
+      // the output is rounded to 16 bits
+      constexpr auto TOLERANCE = 0.5f / 32768.f + 1e-7f;
+      ASSERT_NEAR(expected.getSample(channel, i),
+                  output.getSamples().getSample(channel, i), TOLERANCE)
+          << "at sample " << i << " of channel " << channel;
+    }
+  }
+
+  // cleanup
+  testDirectory().deleteRecursively();
+}
+
+TEST(ProcessorFileIoTest, RunningOnADecodedInputEqualsReadingTheFile) {
+  // given
+  writeInputFile("input.wav", 2, 1000);
+  auto spec = specFor<OnePoleLowPass>("input.wav");
+  spec.blockSchedule = {.blockSize = 96};
+  ProcessorFileIoTest<OnePoleLowPass> test{spec};
+  test.run();
+  juce::MemoryBlock readFromFile;
+  ASSERT_TRUE(
+      juce::File{test.getOutputFilePath()}.loadFileAsData(readFromFile));
+
+  // when
+  test.run(load(inputFile("input.wav")));
+
+  // then
+  juce::MemoryBlock decoded;
+  ASSERT_TRUE(juce::File{test.getOutputFilePath()}.loadFileAsData(decoded));
+  EXPECT_EQ(readFromFile, decoded);
+
+  // cleanup
+  testDirectory().deleteRecursively();
+}
+
+TEST(ProcessorFileIoTest, WritesOnlyStatisticsIfTheOutputMatchesTheReference) {
+  // given the output of an earlier run as the reference
+  writeInputFile("input.wav", 1, 1000);
+  {
+    ProcessorFileIoTest<OnePoleLowPass> earlierRun{
+        specFor<OnePoleLowPass>("input.wav")};
+    earlierRun.run();
+    ASSERT_TRUE(juce::File{earlierRun.getOutputFilePath()}.moveFileTo(
+        inputFile("reference.wav")));
+  }
+  const auto outputDirectory = testDirectory().getChildFile("output");
+  auto spec = specFor<OnePoleLowPass>("input.wav");
+  spec.audioOutputFilesDirectoryPath =
+      outputDirectory.getFullPathName().toStdString();
+  spec.writeStatisticsFile = true;
+  spec.referenceAudioFile = "reference.wav";
+  // the reference is rounded to 16 bits
+  spec.referenceTolerance = DecibelsFullScale{-90.f};
+  auto numPreparedProcessors = 0;
+  spec.preProcessCallback = [&](auto&) { ++numPreparedProcessors; };
+  ProcessorFileIoTest<OnePoleLowPass> test{spec};
+
+  // when
+  test.run();
+
+  // then
+  EXPECT_TRUE(test.matchesReference());
+  EXPECT_EQ(1, numPreparedProcessors);
+  const juce::File outputFile{test.getOutputFilePath()};
+  EXPECT_FALSE(outputFile.exists());
+  EXPECT_TRUE(outputFile.withFileExtension(".json").existsAsFile());
+
+  // cleanup
+  testDirectory().deleteRecursively();
+}
+
+TEST(ProcessorFileIoTest, WritesAMismatchingOutputInASecondPass) {
+  // given the unprocessed input as the reference
+  writeInputFile("input.wav", 1, 1000);
+  ASSERT_TRUE(inputFile("input.wav").copyFileTo(inputFile("reference.wav")));
+  const auto outputDirectory = testDirectory().getChildFile("output");
+  auto spec = specFor<OnePoleLowPass>("input.wav");
+  spec.audioOutputFilesDirectoryPath =
+      outputDirectory.getFullPathName().toStdString();
+  spec.writeStatisticsFile = true;
+  spec.referenceAudioFile = "reference.wav";
+  auto numPreparedProcessors = 0;
+  spec.preProcessCallback = [&](auto&) { ++numPreparedProcessors; };
+  ProcessorFileIoTest<OnePoleLowPass> test{spec};
+
+  // when
+  test.run();
+
+  // then
+  EXPECT_FALSE(test.matchesReference());
+  EXPECT_EQ(2, numPreparedProcessors);
+  const juce::File outputFile{test.getOutputFilePath()};
+  EXPECT_TRUE(outputFile.existsAsFile());
+  EXPECT_TRUE(outputFile.withFileExtension(".json").existsAsFile());
+
+  // cleanup
+  testDirectory().deleteRecursively();
+}
+
+TEST(ProcessorFileIoTest, SplitsBlocksAtAutomationEvents) {
+  // given
+  writeInputFile("input.wav", 1, 1000);
+  auto spec = specFor("input.wav");
+  spec.blockSchedule = {.blockSize = 256};
+  std::vector<std::int64_t> appliedAt;
+  for (const auto offset : {250, 100}) {
+    spec.automation.push_back({.sampleOffset = offset,
+                               .apply = [&appliedAt, offset](auto&) {
+                                 appliedAt.push_back(offset);
+                               }});
+  }
+  ProcessorFileIoTest<PassThrough> test{spec};
+
+  // when
+  test.run();
+
+  // then
+  const std::vector<std::pair<std::int64_t, int>> expected{
+      {0, 100}, {100, 150}, {250, 256}, {506, 256}, {762, 238}};
+  EXPECT_EQ(expected, blocksOf(test.getBlockTimings()));
+  EXPECT_EQ((std::vector<std::int64_t>{100, 250}), appliedAt);
+
+  // cleanup
+  testDirectory().deleteRecursively();
+}
+
+TEST(ProcessorFileIoTest, AppliesEventsAtTheSameOffsetInTheGivenOrder) {
+  // given
+  writeInputFile("input.wav", 1, 1000);
+  auto spec = specFor("input.wav");
+  std::vector<int> applied;
+  const auto event = [&applied](std::int64_t offset, int id) {
+    return ProcessorFileIoTest<PassThrough>::AutomationEvent{
+        .sampleOffset = offset,
+        .apply = [&applied, id](auto&) { applied.push_back(id); }};
+  };
+  spec.automation = {event(500, 1), event(500, 2), event(0, 3),
+                     event(500, 4)};
+  ProcessorFileIoTest<PassThrough> test{spec};
+
+  // when
+  test.run();
+
+  // then
+  EXPECT_EQ((std::vector<int>{3, 1, 2, 4}), applied);
+  const std::vector<std::pair<std::int64_t, int>> expected{{0, 500},
+                                                           {500, 500}};
+  EXPECT_EQ(expected, blocksOf(test.getBlockTimings()));
+
+  // cleanup
+  testDirectory().deleteRecursively();
+}
+
+TEST(ProcessorFileIoTest, IgnoresEventsPastTheEndOfTheFile) {
+  // given
+  writeInputFile("input.wav", 1, 1000);
+  auto spec = specFor("input.wav");
+  spec.blockSchedule = {.blockSize = 400};
+  auto numApplied = 0;
+  for (const auto offset : {1000, 5000}) {
+    spec.automation.push_back(
+        {.sampleOffset = offset, .apply = [&](auto&) { ++numApplied; }});
+  }
+  ProcessorFileIoTest<PassThrough> test{spec};
+
+  // when
+  test.run();
+
+  // then
+  EXPECT_EQ(0, numApplied);
+  const std::vector<std::pair<std::int64_t, int>> expected{
+      {0, 400}, {400, 400}, {800, 200}};
+  EXPECT_EQ(expected, blocksOf(test.getBlockTimings()));
+
+  // cleanup
+  testDirectory().deleteRecursively();
+}
+
+TEST(ProcessorFileIoTest, RampsEndAtTheEndSample) {
+  // given
+  struct Parameter {
+    float value = 0.f;
+  };
+
+  // when the interval does not divide the length
+  const auto events = ProcessorFileIoTest<Parameter>::makeRamp(
+      100, 1100, 300, 0.f, 1.f,
+      [](Parameter& parameter, float value) { parameter.value = value; });
+
+  // then
+  std::vector<std::pair<std::int64_t, float>> ramp;
+  for (const auto& event : events) {
+    Parameter parameter;
+    event.apply(parameter);
+    ramp.emplace_back(event.sampleOffset, parameter.value);
+  }
+  const std::vector<std::pair<std::int64_t, float>> expected{
+      {100, 0.f}, {400, 0.3f}, {700, 0.6f}, {1000, 0.9f}, {1100, 1.f}};
+  ASSERT_EQ(expected.size(), ramp.size());
+  for (auto i = 0u; i < expected.size(); ++i) {
+    EXPECT_EQ(expected[i].first, ramp[i].first);
+    EXPECT_FLOAT_EQ(expected[i].second, ramp[i].second);
+  }
+}
+
+TEST(ProcessorFileIoTest, MeasuresTheLatencyOnAnotherProcessorInstance) {
+  // given
+  writeInputFile("input.wav", 1, 1000);
+  auto spec = specFor<DelayingProcessor>("input.wav");
+  spec.blockSchedule = {.blockSize = 100};
+  spec.measureLatencyAndTail = true;
+  spec.impulseResponseDuration = Seconds{0.01f};
+  auto numPreparedProcessors = 0;
+  spec.preProcessCallback = [&](auto&) { ++numPreparedProcessors; };
+  ProcessorFileIoTest<DelayingProcessor> test{spec};
+
+  // when
+  test.run();
+
+  // then
+  ASSERT_TRUE(test.getLatencyAndTail().has_value());
+  const auto& latencyAndTail = *test.getLatencyAndTail();
+  EXPECT_EQ(32, latencyAndTail.measured.latencyInSamples);
+  EXPECT_EQ(32, latencyAndTail.reportedLatencyInSamples);
+  EXPECT_EQ(2, numPreparedProcessors);
+
+  // cleanup
+  testDirectory().deleteRecursively();
+}
+
+TEST(ProcessorFileIoTest, ThrowsIfTheReportedLatencyIsWrong) {
+  // given
+  writeInputFile("input.wav", 1, 1000);
+  auto spec = specFor<DelayingProcessor>("input.wav");
+  spec.blockSchedule = {.blockSize = 100};
+  spec.measureLatencyAndTail = true;
+  spec.impulseResponseDuration = Seconds{0.01f};
+  spec.preProcessCallback = [](auto& processor) {
+    processor.reportedLatency = 16;
+  };
+  ProcessorFileIoTest<DelayingProcessor> test{spec};
+
+  // when, then
+  EXPECT_THROW(test.run(), std::runtime_error);
+
+  // cleanup
+  testDirectory().deleteRecursively();
+}
+}  // namespace wolfsound
@@ -0,0 +1,199 @@
+#define WS_DEFINE_REALTIME_SAFETY_HOOKS
+#include <gtest/gtest.h>
+#include <wolfsound/test/wolfsound_RealtimeSafetyCheck.hpp>
+#include <wolfsound/test/wolfsound_ProcessorFileIoTest.hpp>
+#include <wolfsound/test/wolfsound_TestAudioProcessorBase.hpp>
+#include "processorFileIoTestFixtures.hpp"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace wolfsound {
+namespace {
+struct AllocatingProcessor {
+  void prepare(const juce::dsp::ProcessSpec&) {}
+
+  template <typename Context>
+  void process(const Context&) {
+    if (allocates) {
+      scratch = std::make_unique<float[]>(64u);
+    }
+  }
+
+  bool allocates = false;
+  std::unique_ptr<float[]> scratch;
+};
+
+class AllocatingAudioProcessor : public TestAudioProcessorBase {
+public:
+  void processBlock(juce::AudioBuffer<float>&, juce::MidiBuffer&) override {
+    if (allocates) {
+      scratch = std::make_unique<float[]>(64u);
+    }
+  }
+
+  bool allocates = false;
+  std::unique_ptr<float[]> scratch;
+};
+}  // namespace
+
+TEST(RealtimeSafetyCheck, ArithmeticIsRealtimeSafe) {
+  // given
+  std::vector<float> samples(64, 0.5f);
+
+  // when
+  std::int64_t numViolations = -1;
+  {
+    const ScopedRealtimeSafetyCheck check;
+    for (auto& sample : samples) {
+      sample *= 0.5f;
+    }
+    numViolations = check.getNumViolations();
+  }
+
+  // then
+  EXPECT_TRUE(ScopedRealtimeSafetyCheck::areHooksInstalled());
+  EXPECT_EQ(0, numViolations);
+}
+
+TEST(RealtimeSafetyCheck, ReportsAllocationsWithTheirStackTrace) {
+  // given
+  std::unique_ptr<float[]> samples;
+
+  // when
+  std::vector<RealtimeSafetyViolation> violations;
+  {
+    const ScopedRealtimeSafetyCheck check;
+    samples = std::make_unique<float[]>(1024u);
+    violations = check.getViolations();
+  }
+
+  // then
+  ASSERT_EQ(1u, violations.size());
+  EXPECT_EQ("operator new", violations.front().function);
+  EXPECT_FALSE(violations.front().stackTrace.empty());
+}
+
+TEST(RealtimeSafetyCheck, ReportsMutexLocks) {
+  // given
+  std::mutex mutex;
+
+  // when
+  std::vector<RealtimeSafetyViolation> violations;
+  {
+    const ScopedRealtimeSafetyCheck check;
+    const std::scoped_lock lock{mutex};
+    violations = check.getViolations();
+  }
+
+  // then
+  ASSERT_EQ(1u, violations.size());
+  EXPECT_EQ("pthread_mutex_lock", violations.front().function);
+}
+
+TEST(RealtimeSafetyCheck, ChecksOnlyTheCodeInScope) {
+  // given
+  std::vector<int> allocatedOutsideTheCheck;
+
+  // when
+  allocatedOutsideTheCheck.resize(16u);
+
+  // then
+  EXPECT_NO_THROW(checkRealtimeSafety([] {}));
+  EXPECT_THROW(checkRealtimeSafety([] { std::vector<int> v(16u); }),
+               std::runtime_error);
+}
+
+TEST(RealtimeSafetyCheck, ChecksOnlyTheCurrentThread) {
+  // given a thread that allocates while the check is active; they are
+  // synchronized with atomics only, as locking would be a violation
+  std::atomic<bool> checking{false};
+  std::atomic<bool> allocated{false};
+  std::unique_ptr<float[]> samples;
+  std::jthread otherThread{[&] {
+    while (!checking) {
+    }
+    samples = std::make_unique<float[]>(1024u);
+    allocated = true;
+  }};
+
+  // when
+  std::int64_t numViolations = -1;
+  {
+    const ScopedRealtimeSafetyCheck check;
+    checking = true;
+    while (!allocated) {
+    }
+    numViolations = check.getNumViolations();
+  }
+
+  // then
+  EXPECT_EQ(0, numViolations);
+}
+
+TEST(RealtimeSafetyCheck, ReusesTheGivenStorage) {
+  // given
+  std::vector<RealtimeSafetyViolation> storage;
+  storage.reserve(ScopedRealtimeSafetyCheck::MAX_RECORDED_VIOLATIONS);
+  const auto* data = storage.data();
+
+  std::unique_ptr<float[]> samples;
+
+  // when
+  EXPECT_THROW(checkRealtimeSafety(
+                   [&] { samples = std::make_unique<float[]>(16u); }, storage),
+               std::runtime_error);
+  EXPECT_NO_THROW(checkRealtimeSafety([] {}, storage));
+
+  // then
+  EXPECT_TRUE(storage.empty());
+  EXPECT_EQ(data, storage.data());
+}
+
+TEST(RealtimeSafetyCheck, ProcessorFileIoTestChecksEveryBlockIfAsked) {
+  // given
+  const auto directory =
+      juce::File::getSpecialLocation(
+          juce::File::SpecialLocationType::currentExecutableFile)
+          .getParentDirectory()
+          .getChildFile("realtimeSafetyCheck");
+  writeNoiseFile(directory.getChildFile("input.wav"), 1, 1000);
+  const auto specFor = [&](bool allocate) {
+    return ProcessorFileIoTest<AllocatingProcessor>::Spec{
+        .inputAudioFile = "input.wav",
+        .preProcessCallback =
+            [allocate](auto& processor) { processor.allocates = allocate; },
+        .audioInputFilesDirectoryPath =
+            directory.getFullPathName().toStdString(),
+        .blockSchedule = {.blockSize = 100},
+        .checkRealtimeSafety = true,
+        .writeStatisticsFile = false};
+  };
+  ProcessorFileIoTest<AllocatingProcessor> allocating{specFor(true)};
+  ProcessorFileIoTest<AllocatingProcessor> notAllocating{specFor(false)};
+
+  // when, then
+  EXPECT_THROW(allocating.run(), std::runtime_error);
+  EXPECT_NO_THROW(notAllocating.run());
+  EXPECT_EQ(10u, notAllocating.getBlockTimings().size());
+
+  // cleanup
+  directory.deleteRecursively();
+}
+
+TEST(RealtimeSafetyCheck, ProcessBlockRealtimeSafelyThrowsOnViolations) {
+  // given
+  AllocatingAudioProcessor processor;
+  juce::AudioBuffer<float> buffer{2, 64};
+  juce::MidiBuffer midiMessages;
+
+  // when, then
+  EXPECT_NO_THROW(processor.processBlockRealtimeSafely(buffer, midiMessages));
+  processor.allocates = true;
+  EXPECT_THROW(processor.processBlockRealtimeSafely(buffer, midiMessages),
+               std::runtime_error);
+}
+}  // namespace wolfsound
@@ -0,0 +1,45 @@
+#include <gtest/gtest.h>
+#include <wolfsound/test/wolfsound_ReferenceComparison.hpp>
+#include <vector>
+
+namespace wolfsound {
+TEST(ReferenceComparison, IdenticalSignalsNullCompletely) {
+  // given
+  const std::vector<float> signal(1001, 0.5f);
+  ReferenceComparison comparison;
+
+  // when
+  comparison.add(signal.data(), signal.data(), static_cast<int>(signal.size()));
+  const auto result = comparison.getResult();
+
+  // then
+  EXPECT_EQ(1001, result.numSamples);
+  EXPECT_EQ(0.f, result.maxAbsoluteError);
+  EXPECT_EQ(ReferenceComparison::SILENCE, result.nullDepth);
+  EXPECT_EQ(-ReferenceComparison::SILENCE, result.signalToNoiseRatio);
+}
+
+TEST(ReferenceComparison, MeasuresTheDifference) {
+  // given a reference at -6 dBFS and an error at -60 dBFS, the largest one
+  // in the last, incomplete group of samples
+  const std::vector<float> reference(1003, 0.5f);
+  auto rendered = reference;
+  for (auto& sample : rendered) {
+    sample += 0.001f;
+  }
+  rendered.back() += 0.001f;
+  ReferenceComparison comparison;
+
+  // when, in two blocks
+  comparison.add(rendered.data(), reference.data(), 500);
+  comparison.add(rendered.data() + 500, reference.data() + 500, 503);
+  const auto result = comparison.getResult();
+
+  // then
+  EXPECT_EQ(1003, result.numSamples);
+  EXPECT_NEAR(0.002f, result.maxAbsoluteError, 1e-6f);
+  EXPECT_EQ(DecibelsFullScale{-54.f}, result.maxAbsoluteErrorLevel);
+  EXPECT_EQ(DecibelsFullScale{-60.f}, result.nullDepth);
+  EXPECT_EQ(DecibelsFullScale{54.f}, result.signalToNoiseRatio);
+}
+}  // namespace wolfsound
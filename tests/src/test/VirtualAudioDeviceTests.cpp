@@ -0,0 +1,93 @@
+#include <gtest/gtest.h>
+#include <wolfsound/test/wolfsound_TestAudioProcessorBase.hpp>
+#include <wolfsound/test/wolfsound_VirtualAudioDevice.hpp>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+
+namespace wolfsound {
+namespace {
+class SleepingAudioProcessor : public TestAudioProcessorBase {
+public:
+  explicit SleepingAudioProcessor(std::chrono::milliseconds sleepTime)
+      : sleepTime_{sleepTime} {}
+
+  void processBlock(juce::AudioBuffer<float>&, juce::MidiBuffer&) override {
+    ++numBlocks;
+    std::this_thread::sleep_for(sleepTime_);
+  }
+
+  int numBlocks = 0;
+
+private:
+  std::chrono::milliseconds sleepTime_;
+};
+
+class ThrowingAudioProcessor : public TestAudioProcessorBase {
+public:
+  void processBlock(juce::AudioBuffer<float>&, juce::MidiBuffer&) override {
+    throw std::runtime_error{"processing failed"};
+  }
+
+  void releaseResources() override { released = true; }
+
+  bool released = false;
+};
+}  // namespace
+
+TEST(VirtualAudioDevice, CallsBackAtTheCadenceOfTheBlockSize) {
+  using namespace std::chrono_literals;
+
+  // given
+  SleepingAudioProcessor processor{0ms};
+  const VirtualAudioDevice device{{.sampleRate = 1000.0,
+                                   .blockSize = 10,
+                                   .duration = Seconds{0.2f},
+                                   .realtimePriority = 0}};
+
+  // when
+  const auto start = std::chrono::steady_clock::now();
+  const auto report = device.run(processor);
+  const auto elapsed = std::chrono::steady_clock::now() - start;
+
+  // then
+  EXPECT_EQ(20, report.numCallbacks);
+  EXPECT_EQ(20, processor.numBlocks);
+  EXPECT_EQ(200, report.statistics.numSamples);
+  EXPECT_FALSE(report.realtimePriorityGranted);
+  // the first callback is due immediately, the last one after 190 ms
+  EXPECT_GE(elapsed, 190ms);
+}
+
+TEST(VirtualAudioDevice, ReportsCallbacksThatMissTheirDeadline) {
+  using namespace std::chrono_literals;
+
+  // given
+  SleepingAudioProcessor processor{15ms};
+  const VirtualAudioDevice device{{.sampleRate = 1000.0,
+                                   .blockSize = 10,
+                                   .duration = Seconds{0.05f},
+                                   .realtimePriority = 0}};
+
+  // when
+  const auto report = device.run(processor);
+
+  // then
+  EXPECT_EQ(5, report.numCallbacks);
+  EXPECT_EQ(5, report.numXruns);
+  EXPECT_EQ(5, report.statistics.numBlocksOverBudget);
+}
+
+TEST(VirtualAudioDevice, RethrowsWhatTheProcessorThrows) {
+  // given
+  ThrowingAudioProcessor processor;
+  const VirtualAudioDevice device{{.sampleRate = 1000.0,
+                                   .blockSize = 10,
+                                   .duration = Seconds{0.05f},
+                                   .realtimePriority = 0}};
+
+  // when, then
+  EXPECT_THROW((void)device.run(processor), std::runtime_error);
+  EXPECT_TRUE(processor.released);
+}
+}  // namespace wolfsound
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <wolfsound/file/wolfsound_WavFileWriter.hpp>
+#include "wolfsound/dsp/wolfsound_testSignals.hpp"
+#include <juce_dsp/juce_dsp.h>
+#include <vector>
+
+namespace wolfsound {
+/** @brief Writes white noise with a different seed on every channel.
+ *
+ * The file is 16-bit like the output of ProcessorFileIoTest, so that passing
+ * it through does not change a sample. */
+inline void writeNoiseFile(const juce::File& file,
+                           int numChannels,
+                           int numSamples) {
+  juce::AudioBuffer<float> samples{numChannels, numSamples};
+  for (auto channel = 0; channel < numChannels; ++channel) {
+    const auto noise = generateWhiteNoise(
+        48000_Hz, Seconds{static_cast<float>(numSamples) / 48000.f},
+        static_cast<unsigned>(channel) + 1u);
+    samples.copyFrom(channel, 0, noise.data(), numSamples);
+  }
+  file.getParentDirectory().createDirectory();
+  WavFileWriter{{.absolutePath = file.getFullPathName().toStdString(),
+                 .sampleRate = 48000_Hz}}
+      .write(samples);
+}
+
+/** @brief A one-pole low-pass filter, so that the output depends on the
+ * state carried over from block to block. */
+struct OnePoleLowPass {
+  void prepare(const juce::dsp::ProcessSpec& spec) {
+    states.assign(spec.numChannels, 0.f);
+  }
+
+  template <typename Context>
+  void process(const Context& context) {
+    const auto& block = context.getOutputBlock();
+    for (auto channel = 0u; channel < block.getNumChannels(); ++channel) {
+      auto* samples = block.getChannelPointer(channel);
+      for (auto i = 0u; i < block.getNumSamples(); ++i) {
+        states[channel] += 0.1f * (samples[i] - states[channel]);
+        samples[i] = states[channel];
+      }
+    }
+  }
+
+  std::vector<float> states;
+};
+}  // namespace wolfsound